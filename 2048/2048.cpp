@@ -3,219 +3,175 @@
  * @brief Реализация функций для консольной игры 2048.
  *
  * Содержит определение функций, объявленных в 2048.h.
+ * Каждая функция переносит глобальное состояние в defaultGame(),
+ * выполняет над ним операцию и записывает результат обратно.
  */
 
 #include "2048.h"
+#include "history.h"
+#include "journal.h"
+#include "profile.h"
+#include "render.h"
 
-#include <iostream>
-#include <vector>
-#include <cstdlib>
-#include <ctime>
-#include <fstream>
-#include <iomanip>
-#include <algorithm>
-#include <random>
+#include <optional>
 
 int board[BOARD_SIZE][BOARD_SIZE];
 int score = 0;
 int bestScore = 0;
 
-bool loadGame() {
-    std::ifstream in("savegame.txt");
-    if (!in.is_open()) return false;
+namespace {
+
+const char* const SAVE_FILE = "savegame.bin";
+const char* const JOURNAL_FILE = "savegame.journal";
+// Файлы старого текстового формата, читаются только при загрузке.
+const char* const LEGACY_SAVE_FILE = "savegame.txt";
+const char* const LEGACY_BEST_FILE = "bestscore.txt";
+
+bool journalMode = false;
+Journal journal;
+// Отмена и повтор ходов партии по умолчанию; снимок пишется в move().
+History history;
+// Направление последнего успешного хода, ожидающего появления числа.
+std::optional<Direction> pendingMove;
+
+// Переносит глобальные переменные в партию по умолчанию.
+Game& syncIn() {
+    Game& game = defaultGame();
+    game.setBoard(packBoard(board));
+    game.setScore(score);
+    game.setBestScore(bestScore);
+    return game;
+}
 
-    for (int i = 0; i < BOARD_SIZE; ++i)
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            if (!(in >> board[i][j])) return false;
+// Переносит состояние партии по умолчанию в глобальные переменные.
+void syncOut(const Game& game) {
+    unpackBoard(game.board(), board);
+    score = game.score();
+    bestScore = game.bestScore();
+}
 
-    if (!(in >> score)) return false;
-    in.close();
+}
 
-    std::ifstream bestIn("bestscore.txt");
-    if (bestIn.is_open()) {
-        bestIn >> bestScore;
-        bestIn.close();
-    }
+void setJournalMode(bool enabled) {
+    journalMode = enabled;
+    if (!enabled) journal.close();
+}
 
+bool loadGame() {
+    PROFILE_SCOPE(LoadGame);
+    Game& game = syncIn();
+    pendingMove.reset();
+    history.clear();
+    if (journalMode) {
+        std::uint64_t validBytes = 0;
+        if (Journal::replay(JOURNAL_FILE, game, &validBytes)) {
+            journal.resume(JOURNAL_FILE, validBytes, game);
+            syncOut(game);
+            return true;
+        }
+    }
+    if (!game.load(SAVE_FILE, &history) && !game.loadText(LEGACY_SAVE_FILE, LEGACY_BEST_FILE))
+        return false;
+    if (journalMode) journal.open(JOURNAL_FILE, game);
+    syncOut(game);
     return true;
 }
 
 void saveGame() {
-    std::ofstream out("savegame.txt");
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            out << board[i][j] << ' ';
-        out << '\n';
-    }
-    out << score;
-    out.close();
-
-    if (score > bestScore) {
-        bestScore = score;
-        std::ofstream bestOut("bestscore.txt");
-        bestOut << bestScore;
-        bestOut.close();
+    PROFILE_SCOPE(SaveGame);
+    Game& game = syncIn();
+    if (journalMode) {
+        // Ходы уже в журнале; пачка ходов одного ввода сбрасывается на
+        // диск сейчас, пока игрок не начал ждать.
+        if (game.score() > game.bestScore()) game.setBestScore(game.score());
+        journal.flush();
+    } else {
+        game.save(SAVE_FILE, &history);
     }
+    syncOut(game);
 }
 
 void clearScreen() {
-    std::system("cls");
+    defaultRenderer().invalidate();
+    writeFrame("\x1b[H\x1b[2J");
 }
 
 void printBoard() {
-    clearScreen();
-    std::cout << "Score: " << score << "  Best: " << bestScore << "\n\n";
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            std::cout << std::setw(5) << board[i][j];
-        std::cout << "\n\n";
-    }
+    PROFILE_SCOPE(PrintBoard);
+    writeFrame(defaultRenderer().frame(packBoard(board), score, bestScore));
 }
 
 void generateNumber() {
-    std::vector<std::pair<int, int>> empty;
-    for (int i = 0; i < BOARD_SIZE; ++i)
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            if (board[i][j] == 0)
-                empty.emplace_back(i, j);
-
-    if (!empty.empty()) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<size_t> dis(0, empty.size() - 1);
-        auto [x, y] = empty[dis(gen)];
-        board[x][y] = (rand() % 10 < 9) ? 2 : 4;
-    }
+    Game& game = syncIn();
+    Board moved = game.board();
+    game.generateNumber();
+    if (journalMode && pendingMove && game.board() != moved)
+        journal.recordMove(*pendingMove, moved, game);
+    pendingMove.reset();
+    syncOut(game);
 }
 
 bool moveLeft() {
-    bool moved = false;
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        int temp[BOARD_SIZE] = {};
-        int idx = 0;
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            if (board[i][j] == 0) continue;
-            if (temp[idx] == 0) {
-                temp[idx] = board[i][j];
-            } else if (temp[idx] == board[i][j]) {
-                temp[idx++] *= 2;
-                score += temp[idx - 1];
-            } else {
-                if (++idx < BOARD_SIZE)
-                    temp[idx] = board[i][j];
-            }
-        }
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            if (board[i][j] != temp[j]) moved = true;
-            board[i][j] = temp[j];
-        }
-    }
-    return moved;
+    PROFILE_SCOPE(MoveLeft);
+    return move('a');
 }
 
 bool moveRight() {
-    bool moved = false;
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        int temp[BOARD_SIZE] = {};
-        int idx = BOARD_SIZE - 1;
-        for (int j = BOARD_SIZE - 1; j >= 0; --j) {
-            if (board[i][j] == 0) continue;
-            if (temp[idx] == 0) {
-                temp[idx] = board[i][j];
-            } else if (temp[idx] == board[i][j]) {
-                temp[idx--] *= 2;
-                score += temp[idx + 1];
-            } else {
-                if (--idx >= 0)
-                    temp[idx] = board[i][j];
-            }
-        }
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            if (board[i][j] != temp[j]) moved = true;
-            board[i][j] = temp[j];
-        }
-    }
-    return moved;
+    PROFILE_SCOPE(MoveRight);
+    return move('d');
 }
 
 bool moveUp() {
-    bool moved = false;
-    for (int j = 0; j < BOARD_SIZE; ++j) {
-        int temp[BOARD_SIZE] = {};
-        int idx = 0;
-        for (int i = 0; i < BOARD_SIZE; ++i) {
-            if (board[i][j] == 0) continue;
-            if (temp[idx] == 0) {
-                temp[idx] = board[i][j];
-            } else if (temp[idx] == board[i][j]) {
-                temp[idx++] *= 2;
-                score += temp[idx - 1];
-            } else {
-                if (++idx < BOARD_SIZE)
-                    temp[idx] = board[i][j];
-            }
-        }
-        for (int i = 0; i < BOARD_SIZE; ++i) {
-            if (board[i][j] != temp[i]) moved = true;
-            board[i][j] = temp[i];
-        }
-    }
-    return moved;
+    PROFILE_SCOPE(MoveUp);
+    return move('w');
 }
 
 bool moveDown() {
-    bool moved = false;
-    for (int j = 0; j < BOARD_SIZE; ++j) {
-        int temp[BOARD_SIZE] = {};
-        int idx = BOARD_SIZE - 1;
-        for (int i = BOARD_SIZE - 1; i >= 0; --i) {
-            if (board[i][j] == 0) continue;
-            if (temp[idx] == 0) {
-                temp[idx] = board[i][j];
-            } else if (temp[idx] == board[i][j]) {
-                temp[idx--] *= 2;
-                score += temp[idx + 1];
-            } else {
-                if (--idx >= 0)
-                    temp[idx] = board[i][j];
-            }
-        }
-        for (int i = 0; i < BOARD_SIZE; ++i) {
-            if (board[i][j] != temp[i]) moved = true;
-            board[i][j] = temp[i];
-        }
-    }
-    return moved;
+    PROFILE_SCOPE(MoveDown);
+    return move('s');
 }
 
 bool move(char dir) {
-    switch (dir) {
-        case 'a': return moveLeft();
-        case 'd': return moveRight();
-        case 'w': return moveUp();
-        case 's': return moveDown();
+    Game& game = syncIn();
+    HistoryEntry before = History::capture(game);
+    bool moved = game.move(dir);
+    if (moved) {
+        history.record(before);
+        pendingMove = directionFromChar(dir);
     }
-    return false;
+    syncOut(game);
+    return moved;
+}
+
+bool undoMove() {
+    Game& game = syncIn();
+    bool changed = history.undo(game);
+    // Журнал только дописывается, поэтому после отмены он начинается заново.
+    if (changed && journalMode) journal.open(JOURNAL_FILE, game);
+    pendingMove.reset();
+    syncOut(game);
+    return changed;
+}
+
+bool redoMove() {
+    Game& game = syncIn();
+    bool changed = history.redo(game);
+    if (changed && journalMode) journal.open(JOURNAL_FILE, game);
+    pendingMove.reset();
+    syncOut(game);
+    return changed;
 }
 
 bool canMove() {
-    for (int i = 0; i < BOARD_SIZE; ++i)
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            if (board[i][j] == 0)
-                return true;
-            if (i + 1 < BOARD_SIZE && board[i][j] == board[i + 1][j])
-                return true;
-            if (j + 1 < BOARD_SIZE && board[i][j] == board[i][j + 1])
-                return true;
-        }
-    return false;
+    PROFILE_SCOPE(CanMove);
+    return syncIn().canMove();
 }
 
 void startNewGame() {
-    score = 0;
-    for (int i = 0; i < BOARD_SIZE; ++i)
-        for (int j = 0; j < BOARD_SIZE; ++j)
-            board[i][j] = 0;
-    generateNumber();
-    generateNumber();
+    Game& game = syncIn();
+    game.startNew();
+    history.clear();
+    pendingMove.reset();
+    if (journalMode) journal.open(JOURNAL_FILE, game);
+    syncOut(game);
 }
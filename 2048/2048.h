@@ -5,6 +5,9 @@
  * Содержит определения глобальных переменных и функций, 
  * отвечающих за основную логику игры: загрузка/сохранение состояния, 
  * отрисовка, управление игровым полем, генерация новых чисел, обработка ходов и проверка завершения игры.
+ *
+ * Функции работают с партией defaultGame() (см. game.h); для нескольких
+ * одновременных партий используйте класс Game напрямую.
  */
 
 #ifndef GAME_2048_H
@@ -12,16 +15,14 @@
 
 #include <string>
 
-/**
- * @brief Размер игрового поля (4x4).
- * @type int
- */
-const int BOARD_SIZE = 4;
+#include "board.h"
+#include "game.h"
 
 /**
  * @brief Игровое поле.
  * @type int[BOARD_SIZE][BOARD_SIZE]
- * Значения: степени двойки (2, 4, 8...) или 0 для пустых ячеек
+ * Значения: степени двойки (2, 4, 8... 32768) или 0 для пустых ячеек.
+ * Ходы выполняются над упакованной копией поля (см. board.h).
  */
 extern int board[BOARD_SIZE][BOARD_SIZE];
 
@@ -41,6 +42,9 @@ extern int bestScore;
  * @brief Загружает сохранённое состояние игры из файла.
  * @return bool true, если удалось загрузить, иначе false.
  *
+ * Читает двоичное сохранение savegame.bin (см. savefile.h), а если его нет
+ * или оно повреждено — сохранение старого формата savegame.txt и bestscore.txt.
+ *
  * @code
  * if (!loadGame()) {
  *     startNewGame();
@@ -53,17 +57,39 @@ bool loadGame();
  * @brief Сохраняет текущее состояние игры и лучший счёт в файл.
  * @return void
  *
+ * Записывает savegame.bin через временный файл и переименование,
+ * поэтому прерванная запись не портит предыдущее сохранение.
+ *
  * @code
  * saveGame();
  * @endcode
  */
 void saveGame();
 
+/**
+ * @brief Включает или выключает режим журнала.
+ * @param enabled true — вести журнал ходов savegame.journal (см. journal.h).
+ * @return void
+ *
+ * В режиме журнала startNewGame() начинает журнал, каждый ход с появившимся
+ * числом занимает в нём один байт, а saveGame() не переписывает сохранение,
+ * а только сбрасывает накопленные ходы журнала на диск.
+ * loadGame() восстанавливает партию из журнала, а если его нет — из
+ * обычного сохранения.
+ *
+ * @code
+ * setJournalMode(true);
+ * if (!loadGame()) startNewGame();
+ * @endcode
+ */
+void setJournalMode(bool enabled);
+
 /**
  * @brief Очищает экран консоли.
  * @return void
  *
- * Работает через system("cls") на Windows.
+ * Выводит управляющую последовательность ANSI; следующий printBoard()
+ * нарисует поле целиком.
  *
  * @code
  * clearScreen();
@@ -75,6 +101,9 @@ void clearScreen();
  * @brief Выводит игровое поле в консоль с текущим и лучшим счётом.
  * @return void
  *
+ * Перерисовывает только изменившиеся с прошлого вызова ячейки
+ * (см. render.h) и выводит кадр одним вызовом write().
+ *
  * @code
  * printBoard();
  * @endcode
@@ -152,6 +181,36 @@ bool moveDown();
  */
 bool move(char dir);
 
+/**
+ * @brief Отменяет последний ход вместе с появившимся после него числом.
+ * @return bool true, если ход отменён; false, если отменять нечего.
+ *
+ * Отменить можно до DEFAULT_HISTORY_DEPTH последних ходов (см. history.h);
+ * история записывается в сохранение и восстанавливается loadGame().
+ * В режиме журнала история хранится только в памяти, а журнал после
+ * отмены начинается заново.
+ *
+ * @code
+ * if (undoMove()) {
+ *     saveGame();
+ * }
+ * @endcode
+ */
+bool undoMove();
+
+/**
+ * @brief Повторяет отменённый ход.
+ * @return bool true, если ход повторён; false, если после отмены был новый ход.
+ *
+ * Поле, счёт и генератор возвращаются в состояние до undoMove(), поэтому
+ * появившееся число то же самое.
+ *
+ * @code
+ * redoMove();
+ * @endcode
+ */
+bool redoMove();
+
 /**
  * @brief Проверяет, возможно ли совершить хоть один ход.
  * @return bool true, если можно сделать ход, иначе false (игра окончена).
@@ -0,0 +1,203 @@
+/**
+ * @file ai.cpp
+ * @brief Реализация поиска expectimax.
+ *
+ * Содержит определение функций, объявленных в ai.h.
+ */
+
+#include "ai.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Ветви с вероятностью ниже порога оцениваются статически.
+const float PROB_CUTOFF = 0.0001f;
+// Ограничение глубины итеративного углубления.
+const int MAX_DEPTH = 10;
+// Как часто (в узлах) проверять истечение времени.
+const std::uint64_t CLOCK_CHECK_INTERVAL = 1024;
+
+// Объём арены для поиска глубины depth: на каждом уровне узел выбора
+// держит до четырёх ходов, а случайный узел — до 15 пустых ячеек.
+std::size_t arenaBytesFor(int depth) {
+    return static_cast<std::size_t>(depth) *
+           (ALL_DIRECTIONS.size() + BOARD_SIZE * BOARD_SIZE - 1) * sizeof(Board);
+}
+
+}
+
+float evaluateBoard(Board b) {
+    return defaultEvaluator().evaluate(b);
+}
+
+ExpectimaxSearch::ExpectimaxSearch(int tableBits, std::size_t arenaBytes)
+    : table_(std::size_t{1} << tableBits), evaluator_(&defaultEvaluator()),
+      canonical_(evaluator_->symmetric()), mask_((Board{1} << tableBits) - 1),
+      arena_(arenaBytes) {}
+
+void ExpectimaxSearch::setEvaluator(const BoardEvaluator* evaluator) {
+    evaluator_ = evaluator != nullptr ? evaluator : &defaultEvaluator();
+    canonical_ = canonicalKeys_ && evaluator_->symmetric();
+    clear();
+}
+
+void ExpectimaxSearch::setCanonicalKeys(bool enabled) {
+    canonicalKeys_ = enabled;
+    canonical_ = canonicalKeys_ && evaluator_->symmetric();
+    clear();
+}
+
+void ExpectimaxSearch::clear() {
+    std::fill(table_.begin(), table_.end(), Entry{});
+}
+
+int ExpectimaxSearch::depthFor(Board b) {
+    int empty = countEmpty(b);
+    if (empty >= 9) return 2;
+    if (empty >= 5) return 3;
+    return 4;
+}
+
+float ExpectimaxSearch::maxNode(Board b, int depth, float prob) {
+    ++stats_.nodes;
+    // Список ходов узла живёт в арене до выхода из узла.
+    Arena::Marker marker = arena_.mark();
+    Board* children = arena_.allocate<Board>(ALL_DIRECTIONS.size());
+    if (children == nullptr) {
+        ++stats_.arenaFallbacks;
+        return evaluator_->evaluate(b);
+    }
+    int count = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int unused = 0;
+        Board next = moveBoard(b, dir, unused);
+        if (next != b) children[count++] = next;
+    }
+
+    float best = 0.0f;
+    for (int k = 0; k < count; ++k) {
+        float value = chanceNode(children[k], depth - 1, prob);
+        if (value > best) best = value;
+    }
+    arena_.release(marker);
+    return best;
+}
+
+float ExpectimaxSearch::chanceNode(Board b, int depth, float prob) {
+    ++stats_.nodes;
+    if (timed_ && stats_.nodes % CLOCK_CHECK_INTERVAL == 0 &&
+        std::chrono::steady_clock::now() >= deadline_)
+        aborted_ = true;
+    if (aborted_) return 0.0f;
+    if (depth <= 0 || prob < PROB_CUTOFF) return evaluator_->evaluate(b);
+
+    // Симметричные позиции имеют одно значение, если оценка симметрична.
+    Board key = canonical_ ? canonicalBoard(b).board : b;
+    Entry& entry = table_[static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL >> 32) & mask_)];
+    ++stats_.cacheProbes;
+    if (entry.board == key && entry.depth >= depth) {
+        ++stats_.cacheHits;
+        return entry.value;
+    }
+
+    int empty = countEmpty(b);
+    Arena::Marker marker = arena_.mark();
+    Board* spawns = arena_.allocate<Board>(static_cast<std::size_t>(empty));
+    if (spawns == nullptr) {
+        ++stats_.arenaFallbacks;
+        return evaluator_->evaluate(b);
+    }
+    int count = 0;
+    for (Board cells = emptyMask(b); cells != 0; cells &= cells - 1)
+        spawns[count++] = Board{1} << std::countr_zero(cells);
+
+    float prob2 = prob * 0.9f / static_cast<float>(empty);
+    float prob4 = prob * 0.1f / static_cast<float>(empty);
+    float sum = 0.0f;
+    for (int k = 0; k < count; ++k) {
+        sum += 0.9f * maxNode(b | spawns[k], depth, prob2);
+        sum += 0.1f * maxNode(b | (spawns[k] << 1), depth, prob4);
+    }
+    arena_.release(marker);
+    float value = sum / static_cast<float>(empty);
+
+    if (!aborted_) {
+        entry.board = key;
+        entry.value = value;
+        entry.depth = static_cast<std::uint8_t>(depth);
+    }
+    return value;
+}
+
+bool ExpectimaxSearch::searchRoot(Board b, int depth, Direction& best) {
+    float bestValue = -1.0f;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int unused = 0;
+        Board next = moveBoard(b, dir, unused);
+        if (next == b) continue;
+        float value = chanceNode(next, depth - 1, 1.0f);
+        if (aborted_) return false;
+        if (value > bestValue) {
+            bestValue = value;
+            best = dir;
+        }
+    }
+    if (bestValue < 0.0f) return false;
+    stats_.value = bestValue;
+    return true;
+}
+
+std::optional<Direction> ExpectimaxSearch::bestMove(Board b, const SearchBudget& budget) {
+    stats_ = {};
+    arena_.reset();
+    aborted_ = false;
+    timed_ = budget.time.count() > 0;
+    if (!canMoveBoard(b)) return std::nullopt;
+
+    // Каноническая книга отвечает за все симметричные позиции только
+    // при симметричной оценке.
+    if (book_ != nullptr && (!book_->canonical() || evaluator_->symmetric())) {
+        int required = budget.depth > 0 ? budget.depth : depthFor(b);
+        std::optional<BookEntry> entry = book_->find(b);
+        if (entry && entry->depth >= required) {
+            stats_.depth = entry->depth;
+            stats_.value = entry->value;
+            stats_.bookHit = true;
+            return static_cast<Direction>(entry->move);
+        }
+    }
+
+    Direction best = Direction::Up;
+    if (!timed_) {
+        stats_.depth = budget.depth > 0 ? budget.depth : depthFor(b);
+        arena_.reserve(arenaBytesFor(stats_.depth));
+        if (!searchRoot(b, stats_.depth, best)) return std::nullopt;
+        return best;
+    }
+
+    deadline_ = std::chrono::steady_clock::now() + budget.time;
+    bool found = false;
+    int maxDepth = budget.depth > 0 ? budget.depth : MAX_DEPTH;
+    arena_.reserve(arenaBytesFor(maxDepth));
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        Direction candidate = best;
+        if (!searchRoot(b, depth, candidate)) break;
+        best = candidate;
+        found = true;
+        stats_.depth = depth;
+    }
+    if (!found) {
+        // Даже глубина 1 не уложилась во время: выбираем любой допустимый ход.
+        timed_ = false;
+        aborted_ = false;
+        searchRoot(b, 1, best);
+    }
+    return best;
+}
+
+std::optional<Direction> bestMove(Board state, const SearchBudget& budget) {
+    thread_local ExpectimaxSearch search;
+    return search.bestMove(state, budget);
+}
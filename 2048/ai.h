@@ -0,0 +1,196 @@
+/**
+ * @file ai.h
+ * @brief Поиск expectimax для выбора лучшего хода.
+ *
+ * Узлы выбора перебирают четыре хода, случайные узлы — появление
+ * 2 (90%) или 4 (10%) в каждой пустой ячейке, как в generateNumber().
+ * Результаты случайных узлов запоминаются в таблице транспозиций
+ * фиксированного размера; маловероятные ветви отсекаются. Если оценка
+ * симметрична (BoardEvaluator::symmetric()), ключ таблицы — каноническое
+ * поле (см. canonicalBoard()), и восемь симметричных позиций занимают
+ * одну запись.
+ * Листья оцениваются табличной оценкой (см. eval.h).
+ * Глубина выбирается по количеству пустых ячеек, либо поиск
+ * углубляется итеративно, пока не истечёт заданное время.
+ * Готовые результаты для частых позиций берутся из книги (см. book.h).
+ * Списки ходов и появлений чисел в узлах выделяются из арены поиска
+ * (см. arena.h), которая сбрасывается перед каждым ходом.
+ */
+
+#ifndef GAME_2048_AI_H
+#define GAME_2048_AI_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "arena.h"
+#include "board.h"
+#include "book.h"
+#include "eval.h"
+
+/**
+ * @brief Ограничения поиска.
+ *
+ * Если задано time, поиск углубляется итеративно и возвращает
+ * результат последней полностью завершённой глубины.
+ * Иначе используется depth, а при depth == 0 — глубина по числу пустых ячеек.
+ */
+struct SearchBudget {
+    int depth = 0;                          ///< Глубина в ходах игрока (0 — автоматически).
+    std::chrono::microseconds time{0};      ///< Время на ход (0 — без ограничения).
+    int playouts = 0;                       ///< Случайных партий на направление для Монте-Карло (0 — 100).
+};
+
+/**
+ * @brief Статистика последнего поиска.
+ */
+struct SearchStats {
+    std::uint64_t nodes = 0;        ///< Посещено узлов.
+    std::uint64_t cacheProbes = 0;  ///< Обращений к таблице транспозиций.
+    std::uint64_t cacheHits = 0;    ///< Попаданий в таблицу транспозиций.
+    int depth = 0;                  ///< Достигнутая глубина.
+    float value = 0.0f;             ///< Ожидаемая оценка выбранного хода.
+    bool bookHit = false;           ///< Ход взят из книги, поиск не выполнялся.
+    std::uint64_t arenaFallbacks = 0;  ///< Узлов, оценённых статически из-за нехватки арены.
+};
+
+/**
+ * @brief Поиск expectimax с таблицей транспозиций.
+ *
+ * Экземпляр не потокобезопасен: используйте по одному на поток.
+ *
+ * @code
+ * ExpectimaxSearch search;
+ * auto dir = search.bestMove(game.board(), {});
+ * if (dir) game.move(*dir);
+ * @endcode
+ */
+class ExpectimaxSearch {
+public:
+    /**
+     * @brief Создаёт поиск с таблицей из 2^tableBits записей.
+     * @param tableBits Логарифм размера таблицы транспозиций.
+     * @param arenaBytes Начальная ёмкость арены для списков ходов узлов.
+     *
+     * На каждый уровень глубины в арене лежат не больше 4 + 15 полей, и
+     * bestMove() перед поиском увеличивает арену до размера, нужного для
+     * его наибольшей глубины, так что выбор хода от ёмкости не зависит.
+     * Если арены всё же не хватит, узел оценивается статически и это
+     * учитывается в SearchStats::arenaFallbacks.
+     */
+    explicit ExpectimaxSearch(int tableBits = 20, std::size_t arenaBytes = 1 << 16);
+
+    /**
+     * @brief Выбирает лучший ход.
+     * @param b Упакованное поле.
+     * @param budget Ограничения поиска.
+     * @return std::optional<Direction> лучший ход или std::nullopt, если ходов нет.
+     */
+    std::optional<Direction> bestMove(Board b, const SearchBudget& budget);
+
+    /**
+     * @brief Статистика последнего вызова bestMove().
+     * @return const SearchStats& статистика.
+     */
+    const SearchStats& stats() const { return stats_; }
+
+    /**
+     * @brief Статистика арены: ёмкость, пик последнего поиска, выделения, сбросы.
+     * @return const ArenaStats& статистика.
+     */
+    const ArenaStats& arenaStats() const { return arena_.stats(); }
+
+    /**
+     * @brief Подключает книгу ходов.
+     * @param book Книга или nullptr; должна жить дольше поиска.
+     * @return void
+     *
+     * Если позиция есть в книге и записана с глубиной не меньше
+     * требуемой, bestMove() возвращает ход из книги без поиска.
+     * Книга с каноническими полями используется, только если оценка
+     * симметрична (BoardEvaluator::symmetric()).
+     */
+    void setBook(const OpeningBook* book) { book_ = book; }
+
+    /**
+     * @brief Задаёт оценку листьев.
+     * @param evaluator Оценщик или nullptr для defaultEvaluator(); должен жить дольше поиска.
+     * @return void
+     *
+     * Очищает таблицу транспозиций: в ней оценки прежнего оценщика.
+     */
+    void setEvaluator(const BoardEvaluator* evaluator);
+
+    /**
+     * @brief Включает ключи таблицы по каноническому полю.
+     * @param enabled true (по умолчанию) — использовать канонические ключи,
+     *        если оценка симметрична; false — всегда само поле.
+     * @return void
+     *
+     * Очищает таблицу транспозиций: записи хранятся под ключами прежнего вида.
+     */
+    void setCanonicalKeys(bool enabled);
+
+    /**
+     * @brief Используются ли сейчас канонические ключи.
+     * @return bool true, если они включены и оценка симметрична.
+     */
+    bool canonicalKeys() const { return canonical_; }
+
+    /**
+     * @brief Очищает таблицу транспозиций.
+     * @return void
+     */
+    void clear();
+
+    /**
+     * @brief Глубина поиска по количеству пустых ячеек.
+     * @param b Упакованное поле.
+     * @return int глубина в ходах игрока.
+     */
+    static int depthFor(Board b);
+
+private:
+    struct Entry {
+        Board board = 0;
+        float value = 0.0f;
+        std::uint8_t depth = 0;
+    };
+
+    float maxNode(Board b, int depth, float prob);
+    float chanceNode(Board b, int depth, float prob);
+    bool searchRoot(Board b, int depth, Direction& best);
+
+    std::vector<Entry> table_;
+    const OpeningBook* book_ = nullptr;
+    const BoardEvaluator* evaluator_;
+    bool canonicalKeys_ = true;
+    bool canonical_ = false;
+    Board mask_;
+    SearchStats stats_;
+    Arena arena_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool timed_ = false;
+    bool aborted_ = false;
+};
+
+/**
+ * @brief Выбирает лучший ход поиском, принадлежащим текущему потоку.
+ * @param state Упакованное поле.
+ * @param budget Ограничения поиска.
+ * @return std::optional<Direction> лучший ход или std::nullopt, если ходов нет.
+ */
+std::optional<Direction> bestMove(Board state, const SearchBudget& budget);
+
+/**
+ * @brief Статическая оценка позиции весами по умолчанию.
+ * @param b Упакованное поле.
+ * @return float оценка (больше — лучше).
+ *
+ * То же, что defaultEvaluator().evaluate(b).
+ */
+float evaluateBoard(Board b);
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file arena.h
+ * @brief Арена с выделением сдвигом указателя для данных одного поиска.
+ *
+ * Память выделяется один раз при создании арены. allocate() только
+ * выравнивает и сдвигает указатель, освобождение — откат к отметке
+ * (mark() / release()) при выходе из узла или reset() перед следующим
+ * ходом. Поэтому в цикле поиска нет обращений к new/delete, а
+ * потребление памяти ограничено ёмкостью арены: если места не хватает,
+ * allocate() возвращает nullptr, и вызывающий обходится без выделения.
+ * reserve() увеличивает ёмкость между поисками, когда заранее известно,
+ * сколько памяти понадобится.
+ */
+
+#ifndef GAME_2048_ARENA_H
+#define GAME_2048_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief Статистика арены.
+ */
+struct ArenaStats {
+    std::size_t capacity = 0;       ///< Ёмкость в байтах.
+    std::size_t used = 0;           ///< Занято сейчас.
+    std::size_t peak = 0;           ///< Наибольшее занятое с последнего reset().
+    std::uint64_t allocations = 0;  ///< Успешных выделений с создания.
+    std::uint64_t failures = 0;     ///< Выделений, не поместившихся в арену.
+    std::uint64_t resets = 0;       ///< Вызовов reset().
+};
+
+/**
+ * @brief Арена фиксированной ёмкости.
+ *
+ * @code
+ * Arena arena(1 << 16);
+ * Arena::Marker marker = arena.mark();
+ * Board* children = arena.allocate<Board>(4);
+ * // ...
+ * arena.release(marker);
+ * @endcode
+ */
+class Arena {
+public:
+    /** @brief Отметка для отката: занятый объём в момент mark(). */
+    using Marker = std::size_t;
+
+    /**
+     * @brief Выделяет память арены.
+     * @param capacity Ёмкость в байтах.
+     */
+    explicit Arena(std::size_t capacity)
+        : memory_(std::make_unique<std::byte[]>(capacity)) {
+        stats_.capacity = capacity;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Выделяет массив из n объектов T без инициализации.
+     * @tparam T Тривиальный тип.
+     * @param n Количество объектов.
+     * @return T* начало массива или nullptr, если не хватает места.
+     */
+    template <typename T>
+    T* allocate(std::size_t n) {
+        static_assert(std::is_trivially_destructible_v<T>, "arena never runs destructors");
+        std::size_t begin = (stats_.used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (begin + n * sizeof(T) > stats_.capacity) {
+            ++stats_.failures;
+            return nullptr;
+        }
+        stats_.used = begin + n * sizeof(T);
+        if (stats_.used > stats_.peak) stats_.peak = stats_.used;
+        ++stats_.allocations;
+        return reinterpret_cast<T*>(memory_.get() + begin);
+    }
+
+    /**
+     * @brief Текущая отметка.
+     * @return Marker отметка для release().
+     */
+    Marker mark() const { return stats_.used; }
+
+    /**
+     * @brief Освобождает всё выделенное после отметки.
+     * @param marker Отметка, полученная от mark().
+     * @return void
+     */
+    void release(Marker marker) { stats_.used = marker; }
+
+    /**
+     * @brief Увеличивает ёмкость не меньше чем до capacity.
+     * @param capacity Требуемая ёмкость в байтах.
+     * @return void
+     *
+     * Вызывается только для пустой арены: прежняя память освобождается.
+     */
+    void reserve(std::size_t capacity) {
+        if (capacity <= stats_.capacity) return;
+        memory_ = std::make_unique<std::byte[]>(capacity);
+        stats_.capacity = capacity;
+    }
+
+    /**
+     * @brief Освобождает всё и сбрасывает пик; вызывается перед каждым ходом.
+     * @return void
+     */
+    void reset() {
+        stats_.used = 0;
+        stats_.peak = 0;
+        ++stats_.resets;
+    }
+
+    /**
+     * @brief Статистика арены.
+     * @return const ArenaStats& статистика.
+     */
+    const ArenaStats& stats() const { return stats_; }
+
+private:
+    std::unique_ptr<std::byte[]> memory_;
+    ArenaStats stats_;
+};
+
+#endif
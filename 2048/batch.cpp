@@ -0,0 +1,132 @@
+/**
+ * @file batch.cpp
+ * @brief Реализация пакетного хода.
+ *
+ * Содержит определение функций, объявленных в batch.h.
+ */
+
+#include "batch.h"
+
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GAME_2048_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void moveBatchScalar(Direction dir, const Board* boards, std::size_t n, Board* outBoards,
+                     int* outScores, bool* outMoved) {
+    for (std::size_t i = 0; i < n; ++i) {
+        int gained = 0;
+        outBoards[i] = moveBoard(boards[i], dir, gained);
+        outScores[i] = gained;
+        outMoved[i] = outBoards[i] != boards[i];
+    }
+}
+
+#ifdef GAME_2048_HAVE_AVX2
+
+// gather читает 4 байта по адресу left/right + 2 * row; для последней
+// строки таблицы лишние 2 байта приходятся на следующий массив RowTables.
+static_assert(offsetof(RowTables, right) == offsetof(RowTables, left) + sizeof(RowTables::left));
+static_assert(offsetof(RowTables, score) == offsetof(RowTables, right) + sizeof(RowTables::right));
+
+__attribute__((target("avx2"))) inline __m256i splat(std::uint64_t value) {
+    return _mm256_set1_epi64x(static_cast<long long>(value));
+}
+
+// transpose() из board.h для четырёх полей сразу.
+__attribute__((target("avx2"))) inline __m256i transpose4(__m256i x) {
+    __m256i a1 = _mm256_and_si256(x, splat(0xF0F00F0FF0F00F0FULL));
+    __m256i a2 = _mm256_and_si256(x, splat(0x0000F0F00000F0F0ULL));
+    __m256i a3 = _mm256_and_si256(x, splat(0x0F0F00000F0F0000ULL));
+    __m256i a = _mm256_or_si256(a1, _mm256_or_si256(_mm256_slli_epi64(a2, 12),
+                                                    _mm256_srli_epi64(a3, 12)));
+    __m256i b1 = _mm256_and_si256(a, splat(0xFF00FF0000FF00FFULL));
+    __m256i b2 = _mm256_and_si256(a, splat(0x00FF00FF00000000ULL));
+    __m256i b3 = _mm256_and_si256(a, splat(0x00000000FF00FF00ULL));
+    return _mm256_or_si256(b1, _mm256_or_si256(_mm256_srli_epi64(b2, 24),
+                                               _mm256_slli_epi64(b3, 24)));
+}
+
+__attribute__((target("avx2"))) void moveBatchAvx2(Direction dir, const Board* boards,
+                                                   std::size_t n, Board* outBoards,
+                                                   int* outScores, bool* outMoved) {
+    bool vertical = dir == Direction::Up || dir == Direction::Down;
+    const auto& table =
+        (dir == Direction::Left || dir == Direction::Up) ? rowTables.left : rowTables.right;
+    const int* rowBase = reinterpret_cast<const int*>(table.data());
+    const int* scoreBase = rowTables.score.data();
+    const __m256i rowMask = splat(0xFFFF);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boards + i));
+        __m256i src = vertical ? transpose4(in) : in;
+        __m256i result = _mm256_setzero_si256();
+        __m128i gained = _mm_setzero_si128();
+        for (unsigned r = 0; r < 4; ++r) {
+            __m256i shift = splat(16 * r);
+            __m256i row = _mm256_and_si256(_mm256_srlv_epi64(src, shift), rowMask);
+            __m128i moved = _mm256_i64gather_epi32(rowBase, row, 2);
+            __m256i moved64 = _mm256_and_si256(_mm256_cvtepu32_epi64(moved), rowMask);
+            result = _mm256_or_si256(result, _mm256_sllv_epi64(moved64, shift));
+            gained = _mm_add_epi32(gained, _mm256_i64gather_epi32(scoreBase, row, 4));
+        }
+        if (vertical) result = transpose4(result);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outBoards + i), result);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outScores + i), gained);
+        int same = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(result, in)));
+        for (unsigned k = 0; k < 4; ++k)
+            outMoved[i + k] = ((same >> k) & 1) == 0;
+    }
+    moveBatchScalar(dir, boards + i, n - i, outBoards + i, outScores + i, outMoved + i);
+}
+
+#endif
+
+}
+
+bool batchKernelSupported(BatchKernel kernel) {
+    switch (kernel) {
+        case BatchKernel::Scalar: return true;
+        case BatchKernel::Avx2:
+#ifdef GAME_2048_HAVE_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+BatchKernel activeBatchKernel() {
+    static const BatchKernel kernel =
+        batchKernelSupported(BatchKernel::Avx2) ? BatchKernel::Avx2 : BatchKernel::Scalar;
+    return kernel;
+}
+
+const char* batchKernelName(BatchKernel kernel) {
+    return kernel == BatchKernel::Avx2 ? "avx2" : "scalar";
+}
+
+void moveBatchWith(BatchKernel kernel, Direction dir, const Board* boards, std::size_t n,
+                   Board* outBoards, int* outScores, bool* outMoved) {
+#ifdef GAME_2048_HAVE_AVX2
+    if (kernel == BatchKernel::Avx2) {
+        moveBatchAvx2(dir, boards, n, outBoards, outScores, outMoved);
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    moveBatchScalar(dir, boards, n, outBoards, outScores, outMoved);
+}
+
+void moveBatch(Direction dir, const Board* boards, std::size_t n, Board* outBoards,
+               int* outScores, bool* outMoved) {
+    moveBatchWith(activeBatchKernel(), dir, boards, n, outBoards, outScores, outMoved);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file batch.h
+ * @brief Один ход сразу для массива полей.
+ *
+ * Входные поля и результаты лежат в отдельных массивах (структура
+ * массивов), что позволяет обрабатывать по нескольку полей за шаг.
+ * Ядро выбирается при первом вызове: AVX2 (транспонирование четырёх
+ * полей в одном регистре и выборка строк из таблиц через gather),
+ * если процессор его поддерживает, иначе скалярный цикл по moveBoard().
+ */
+
+#ifndef GAME_2048_BATCH_H
+#define GAME_2048_BATCH_H
+
+#include <cstddef>
+
+#include "board.h"
+
+/**
+ * @brief Реализация пакетного хода.
+ */
+enum class BatchKernel { Scalar, Avx2 };
+
+/**
+ * @brief Ядро, которое использует moveBatch() на этом процессоре.
+ * @return BatchKernel выбранное ядро.
+ */
+BatchKernel activeBatchKernel();
+
+/**
+ * @brief Поддерживается ли ядро на этом процессоре и в этой сборке.
+ * @param kernel Ядро.
+ * @return bool true, если ядро можно вызывать.
+ */
+bool batchKernelSupported(BatchKernel kernel);
+
+/**
+ * @brief Название ядра для отчётов.
+ * @param kernel Ядро.
+ * @return const char* "scalar" или "avx2".
+ */
+const char* batchKernelName(BatchKernel kernel);
+
+/**
+ * @brief Выполняет ход dir для n полей.
+ * @param dir Направление хода.
+ * @param boards Исходные поля.
+ * @param n Количество полей.
+ * @param outBoards Поля после хода.
+ * @param outScores Очки, полученные каждым полем за ход.
+ * @param outMoved true, если поле изменилось.
+ * @return void
+ *
+ * Результат совпадает с moveBoard() для каждого поля.
+ *
+ * @code
+ * moveBatch(Direction::Left, boards.data(), boards.size(),
+ *           next.data(), scores.data(), moved.data());
+ * @endcode
+ */
+void moveBatch(Direction dir, const Board* boards, std::size_t n, Board* outBoards,
+               int* outScores, bool* outMoved);
+
+/**
+ * @brief То же, что moveBatch(), но заданным ядром.
+ * @param kernel Ядро; должно поддерживаться (см. batchKernelSupported()).
+ * @param dir Направление хода.
+ * @param boards Исходные поля.
+ * @param n Количество полей.
+ * @param outBoards Поля после хода.
+ * @param outScores Очки, полученные каждым полем за ход.
+ * @param outMoved true, если поле изменилось.
+ * @return void
+ */
+void moveBatchWith(BatchKernel kernel, Direction dir, const Board* boards, std::size_t n,
+                   Board* outBoards, int* outScores, bool* outMoved);
+
+#endif
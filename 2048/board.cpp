@@ -0,0 +1,78 @@
+/**
+ * @file board.cpp
+ * @brief Построение таблиц ходов и преобразования упакованного поля.
+ *
+ * Содержит определение функций, объявленных в board.h.
+ */
+
+#include "board.h"
+
+namespace {
+
+constexpr std::uint16_t reverseRow(std::uint16_t row) {
+    return static_cast<std::uint16_t>(((row & 0x000F) << 12) | ((row & 0x00F0) << 4) |
+                                      ((row & 0x0F00) >> 4) | ((row & 0xF000) >> 12));
+}
+
+// Те же правила, что и в исходном moveLeft(): каждая плитка объединяется
+// не более одного раза за ход.
+constexpr std::uint16_t slideRowLeft(std::uint16_t row, int& gained) {
+    int temp[BOARD_SIZE] = {};
+    int idx = 0;
+    for (int j = 0; j < BOARD_SIZE; ++j) {
+        int cell = (row >> (4 * j)) & 0xF;
+        if (cell == 0) continue;
+        if (temp[idx] == 0) {
+            temp[idx] = cell;
+        } else if (temp[idx] == cell && cell < MAX_EXPONENT) {
+            temp[idx++] += 1;
+            gained += 1 << (cell + 1);
+        } else {
+            if (++idx < BOARD_SIZE)
+                temp[idx] = cell;
+        }
+    }
+    int result = 0;
+    for (int j = 0; j < BOARD_SIZE; ++j)
+        result |= temp[j] << (4 * j);
+    return static_cast<std::uint16_t>(result);
+}
+
+RowTables buildRowTables() {
+    RowTables tables{};
+    for (int r = 0; r < 65536; ++r) {
+        auto row = static_cast<std::uint16_t>(r);
+        int gained = 0;
+        tables.left[row] = slideRowLeft(row, gained);
+        tables.score[row] = gained;
+        int unused = 0;
+        tables.right[row] = reverseRow(slideRowLeft(reverseRow(row), unused));
+    }
+    return tables;
+}
+
+}
+
+const RowTables rowTables = buildRowTables();
+
+Board packBoard(const int (&cells)[BOARD_SIZE][BOARD_SIZE]) {
+    Board b = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            if (cells[i][j] > 0)
+                b = withCell(b, i, j, std::countr_zero(static_cast<unsigned>(cells[i][j])));
+    return b;
+}
+
+std::optional<Board> tryPackBoard(const int (&cells)[BOARD_SIZE][BOARD_SIZE]) {
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            if (!isTileValue(cells[i][j])) return std::nullopt;
+    return packBoard(cells);
+}
+
+void unpackBoard(Board b, int (&cells)[BOARD_SIZE][BOARD_SIZE]) {
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            cells[i][j] = cellValue(b, i, j);
+}
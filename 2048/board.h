@@ -0,0 +1,489 @@
+/**
+ * @file board.h
+ * @brief Упакованное представление поля 4x4 в одном 64-битном слове.
+ *
+ * Каждая ячейка хранится как 4-битный показатель степени двойки
+ * (0 — пустая ячейка, 1 — 2, 2 — 4, ..., 15 — 32768).
+ * Ячейка (i, j) занимает биты [4 * (4 * i + j), 4 * (4 * i + j) + 4),
+ * то есть строка i — это 16 бит начиная с 16 * i.
+ *
+ * Ходы влево/вправо выполняются четырьмя обращениями к заранее
+ * вычисленным таблицам строк, ходы вверх/вниз — те же обращения
+ * между двумя транспонированиями поля.
+ */
+
+#ifndef GAME_2048_BOARD_H
+#define GAME_2048_BOARD_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Размер игрового поля (4x4).
+ * @type int
+ */
+const int BOARD_SIZE = 4;
+
+/**
+ * @brief Упакованное поле: 16 ячеек по 4 бита.
+ */
+using Board = std::uint64_t;
+
+/**
+ * @brief Версия упаковки поля в Board.
+ *
+ * Записывается в файлы, хранящие упакованные поля (см. book.h);
+ * меняется при любом изменении раскладки ячеек или их кодирования.
+ */
+const std::uint16_t BOARD_ENCODING = 1;
+
+/**
+ * @brief Наибольший показатель степени, помещающийся в ячейку (2^15 = 32768).
+ *
+ * Две плитки 32768 не объединяются: результат не помещается в 4 бита.
+ */
+const int MAX_EXPONENT = 15;
+
+/**
+ * @brief Направление хода.
+ *
+ * Порядок совпадает с клавишами 'w', 'a', 's', 'd'.
+ */
+enum class Direction : std::uint8_t { Up, Left, Down, Right };
+
+/**
+ * @brief Все четыре направления в порядке 'w', 'a', 's', 'd'.
+ */
+inline constexpr std::array<Direction, 4> ALL_DIRECTIONS = {
+    Direction::Up, Direction::Left, Direction::Down, Direction::Right};
+
+/**
+ * @brief Таблицы ходов для всех 65536 возможных строк.
+ *
+ * left[r] / right[r] — строка r после сдвига влево / вправо,
+ * score[r] — очки за объединения в строке r. Очки не зависят от
+ * направления: каждая серия из L равных плиток даёт L / 2 объединений
+ * при сдвиге в любую сторону.
+ */
+struct RowTables {
+    std::array<std::uint16_t, 65536> left;
+    std::array<std::uint16_t, 65536> right;
+    std::array<int, 65536> score;
+};
+
+/**
+ * @brief Таблицы ходов, построенные при статической инициализации программы.
+ */
+extern const RowTables rowTables;
+
+/**
+ * @brief Преобразует символ клавиши в направление.
+ * @param c Символ 'w', 'a', 's' или 'd'.
+ * @return std::optional<Direction> направление или std::nullopt для других символов.
+ */
+constexpr std::optional<Direction> directionFromChar(char c) {
+    switch (c) {
+        case 'w': return Direction::Up;
+        case 'a': return Direction::Left;
+        case 's': return Direction::Down;
+        case 'd': return Direction::Right;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Преобразует направление в символ клавиши.
+ * @param dir Направление хода.
+ * @return char 'w', 'a', 's' или 'd'.
+ */
+constexpr char directionToChar(Direction dir) {
+    return "wasd"[static_cast<int>(dir)];
+}
+
+/**
+ * @brief Возвращает показатель степени в ячейке (0 для пустой).
+ * @param b Упакованное поле.
+ * @param row Номер строки.
+ * @param col Номер столбца.
+ * @return int показатель степени двойки.
+ */
+constexpr int cellExponent(Board b, int row, int col) {
+    return static_cast<int>((b >> (4 * (BOARD_SIZE * row + col))) & 0xF);
+}
+
+/**
+ * @brief Возвращает значение плитки в ячейке (0, 2, 4, ...).
+ * @param b Упакованное поле.
+ * @param row Номер строки.
+ * @param col Номер столбца.
+ * @return int значение плитки.
+ */
+constexpr int cellValue(Board b, int row, int col) {
+    int e = cellExponent(b, row, col);
+    return e == 0 ? 0 : 1 << e;
+}
+
+/**
+ * @brief Возвращает поле с заменённым показателем степени в ячейке.
+ * @param b Упакованное поле.
+ * @param row Номер строки.
+ * @param col Номер столбца.
+ * @param exponent Новый показатель степени (0..15).
+ * @return Board новое поле.
+ */
+constexpr Board withCell(Board b, int row, int col, int exponent) {
+    int shift = 4 * (BOARD_SIZE * row + col);
+    return (b & ~(Board{0xF} << shift)) |
+           (static_cast<Board>(exponent & 0xF) << shift);
+}
+
+/**
+ * @brief Транспонирует поле (строки становятся столбцами).
+ * @param b Упакованное поле.
+ * @return Board транспонированное поле.
+ */
+constexpr Board transpose(Board b) {
+    Board a1 = b & 0xF0F00F0FF0F00F0FULL;
+    Board a2 = b & 0x0000F0F00000F0F0ULL;
+    Board a3 = b & 0x0F0F00000F0F0000ULL;
+    Board a = a1 | (a2 << 12) | (a3 >> 12);
+    Board b1 = a & 0xFF00FF0000FF00FFULL;
+    Board b2 = a & 0x00FF00FF00000000ULL;
+    Board b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+/**
+ * @brief Отражает поле слева направо (столбец j становится столбцом 3 - j).
+ * @param b Упакованное поле.
+ * @return Board отражённое поле.
+ */
+constexpr Board mirrorLeftRight(Board b) {
+    Board x = ((b & 0xF0F0F0F0F0F0F0F0ULL) >> 4) | ((b & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return ((x & 0xFF00FF00FF00FF00ULL) >> 8) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+}
+
+/**
+ * @brief Отражает поле сверху вниз (строка i становится строкой 3 - i).
+ * @param b Упакованное поле.
+ * @return Board отражённое поле.
+ */
+constexpr Board mirrorUpDown(Board b) {
+    Board x = (b >> 32) | (b << 32);
+    return ((x & 0xFFFF0000FFFF0000ULL) >> 16) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+}
+
+/**
+ * @brief Число симметрий квадратного поля: 4 поворота и 4 отражения.
+ */
+const int SYMMETRY_COUNT = 8;
+
+/**
+ * @brief Применяет одну из восьми симметрий поля.
+ * @param b Упакованное поле.
+ * @param symmetry Номер симметрии 0..7: бит 2 — транспонирование, затем
+ *        бит 0 — mirrorLeftRight(), бит 1 — mirrorUpDown(). 0 — тождественная.
+ * @return Board преобразованное поле.
+ */
+constexpr Board applySymmetry(Board b, int symmetry) {
+    if ((symmetry & 4) != 0) b = transpose(b);
+    if ((symmetry & 1) != 0) b = mirrorLeftRight(b);
+    if ((symmetry & 2) != 0) b = mirrorUpDown(b);
+    return b;
+}
+
+/**
+ * @brief Ячейка, в которую applySymmetry() переносит ячейку cell.
+ * @param cell Номер ячейки (4 * строка + столбец).
+ * @param symmetry Номер симметрии 0..7.
+ * @return int номер ячейки после преобразования.
+ */
+constexpr int symmetryCell(int cell, int symmetry) {
+    int row = cell / BOARD_SIZE;
+    int col = cell % BOARD_SIZE;
+    if ((symmetry & 4) != 0) {
+        int t = row;
+        row = col;
+        col = t;
+    }
+    if ((symmetry & 1) != 0) col = BOARD_SIZE - 1 - col;
+    if ((symmetry & 2) != 0) row = BOARD_SIZE - 1 - row;
+    return BOARD_SIZE * row + col;
+}
+
+/**
+ * @brief Направление хода на преобразованном поле.
+ * @param dir Ход на исходном поле.
+ * @param symmetry Номер симметрии 0..7.
+ * @return Direction ход, который на applySymmetry(b, symmetry) даёт
+ *         applySymmetry(moveBoard(b, dir), symmetry).
+ */
+constexpr Direction symmetryDirection(Direction dir, int symmetry) {
+    // Up, Left, Down, Right = 0, 1, 2, 3: транспонирование меняет
+    // Up и Left, Down и Right; отражения меняют противоположные ходы.
+    auto d = static_cast<std::uint8_t>(dir);
+    if ((symmetry & 4) != 0) d ^= 1;
+    if ((symmetry & 1) != 0 && (d & 1) != 0) d ^= 2;
+    if ((symmetry & 2) != 0 && (d & 1) == 0) d ^= 2;
+    return static_cast<Direction>(d);
+}
+
+/**
+ * @brief Обратное к symmetryDirection(): ход на исходном поле.
+ * @param dir Ход на преобразованном поле.
+ * @param symmetry Номер симметрии 0..7.
+ * @return Direction ход на исходном поле.
+ */
+constexpr Direction inverseSymmetryDirection(Direction dir, int symmetry) {
+    auto d = static_cast<std::uint8_t>(dir);
+    if ((symmetry & 2) != 0 && (d & 1) == 0) d ^= 2;
+    if ((symmetry & 1) != 0 && (d & 1) != 0) d ^= 2;
+    if ((symmetry & 4) != 0) d ^= 1;
+    return static_cast<Direction>(d);
+}
+
+/**
+ * @brief Каноническое поле и симметрия, которая к нему приводит.
+ */
+struct CanonicalBoard {
+    Board board = 0;    ///< Наименьшее из восьми симметричных полей.
+    int symmetry = 0;   ///< board == applySymmetry(исходное поле, symmetry).
+};
+
+/**
+ * @brief Приводит поле к канонической форме.
+ * @param b Упакованное поле.
+ * @return CanonicalBoard наименьшее из восьми симметричных полей.
+ *
+ * Симметричные поля дают одно и то же каноническое поле, поэтому
+ * кэши, ключом которых служит каноническое поле, хранят позицию один
+ * раз вместо восьми. Ход для исходного поля получается из хода для
+ * канонического через inverseSymmetryDirection().
+ *
+ * @code
+ * CanonicalBoard key = canonicalBoard(b);
+ * Direction dir = inverseSymmetryDirection(cachedMove(key.board), key.symmetry);
+ * @endcode
+ */
+constexpr CanonicalBoard canonicalBoard(Board b) {
+    CanonicalBoard best{b, 0};
+    Board sources[2] = {b, transpose(b)};
+    for (int t = 0; t < 2; ++t) {
+        Board lr = mirrorLeftRight(sources[t]);
+        Board candidates[4] = {sources[t], lr, mirrorUpDown(sources[t]), mirrorUpDown(lr)};
+        for (int k = 0; k < 4; ++k)
+            if (candidates[k] < best.board) best = {candidates[k], 4 * t + k};
+    }
+    return best;
+}
+
+/**
+ * @brief Маска младших битов непустых ячеек (бит 4k установлен, если ячейка k не пуста).
+ * @param b Упакованное поле.
+ * @return Board маска вида 0x1111...
+ */
+constexpr Board occupiedMask(Board b) {
+    b |= b >> 1;
+    b |= b >> 2;
+    return b & 0x1111111111111111ULL;
+}
+
+/**
+ * @brief Маска младших битов пустых ячеек (бит 4k установлен, если ячейка k пуста).
+ * @param b Упакованное поле.
+ * @return Board маска вида 0x1111...
+ */
+constexpr Board emptyMask(Board b) {
+    return ~occupiedMask(b) & 0x1111111111111111ULL;
+}
+
+/**
+ * @brief Позиция k-го установленного бита маски.
+ * @param mask Маска (обычно emptyMask()).
+ * @param k Номер бита, от 0 до popcount(mask) - 1.
+ * @return int номер бита.
+ *
+ * С BMI2 — одна инструкция pdep, иначе сбрасывает k младших
+ * установленных битов и берёт позицию следующего.
+ */
+constexpr int nthSetBit(Board mask, int k) {
+#if defined(__BMI2__)
+    if (!std::is_constant_evaluated())
+        return std::countr_zero(_pdep_u64(Board{1} << k, mask));
+#endif
+    for (; k > 0; --k)
+        mask &= mask - 1;
+    return std::countr_zero(mask);
+}
+
+/**
+ * @brief Сдвиг (в битах) k-й по счёту пустой ячейки.
+ * @param b Упакованное поле.
+ * @param k Номер пустой ячейки, от 0 до countEmpty(b) - 1.
+ * @return int сдвиг 4 * номер ячейки.
+ */
+constexpr int nthEmptyShift(Board b, int k) {
+    return nthSetBit(emptyMask(b), k);
+}
+
+/**
+ * @brief Маска ячеек с плиткой наибольшего значения (MAX_EXPONENT).
+ * @param b Упакованное поле.
+ * @return Board бит 4k установлен, если в ячейке k плитка 32768.
+ */
+constexpr Board cappedMask(Board b) {
+    return b & (b >> 1) & (b >> 2) & (b >> 3) & 0x1111111111111111ULL;
+}
+
+/**
+ * @brief Маска пар соседних равных ячеек, которые можно объединить.
+ * @param b Упакованное поле.
+ * @return Board бит 4k установлен, если ячейка k равна правому соседу;
+ *         бит 4k + 2 — если ячейка k равна нижнему соседу.
+ *
+ * Пустые ячейки тоже считаются равными друг другу. Пары плиток 32768
+ * не объединяются (см. moveBoard()) и в маску не входят.
+ */
+constexpr Board equalPairsMask(Board b) {
+    // Соседи по строке: ячейка k против k + 1, кроме последнего столбца.
+    const Board rowPairs = 0x0111011101110111ULL;
+    // Соседи по столбцу: ячейка k против k + 4, кроме последней строки.
+    const Board colPairs = 0x0000111111111111ULL;
+
+    Board mergeable = ~cappedMask(b);
+    Board row = ~occupiedMask(b ^ (b >> 4)) & rowPairs & mergeable;
+    Board col = ~occupiedMask(b ^ (b >> 16)) & colPairs & mergeable;
+    return row | (col << 2);
+}
+
+/**
+ * @brief Есть ли две соседние равные непустые плитки.
+ * @param b Упакованное поле.
+ * @return bool true, если какой-то ход объединит плитки.
+ */
+constexpr bool hasMergeablePair(Board b) {
+    Board occupied = occupiedMask(b);
+    return (equalPairsMask(b) & (occupied | (occupied << 2))) != 0;
+}
+
+/**
+ * @brief Равна ли плитка в ячейке хотя бы одному соседу.
+ * @param b Упакованное поле.
+ * @param shift Сдвиг ячейки (4 * номер ячейки).
+ * @return bool true, если у плитки есть равный сосед, с которым она объединится.
+ */
+constexpr bool matchesNeighbor(Board b, int shift) {
+    Board tile = (b >> shift) & 0xF;
+    if (tile == MAX_EXPONENT) return false;
+    int cell = shift / 4;
+    int col = cell % BOARD_SIZE;
+    int row = cell / BOARD_SIZE;
+    return (col > 0 && ((b >> (shift - 4)) & 0xF) == tile) ||
+           (col < BOARD_SIZE - 1 && ((b >> (shift + 4)) & 0xF) == tile) ||
+           (row > 0 && ((b >> (shift - 16)) & 0xF) == tile) ||
+           (row < BOARD_SIZE - 1 && ((b >> (shift + 16)) & 0xF) == tile);
+}
+
+/**
+ * @brief Считает пустые ячейки.
+ * @param b Упакованное поле.
+ * @return int количество пустых ячеек (0..16).
+ */
+constexpr int countEmpty(Board b) {
+    return std::popcount(emptyMask(b));
+}
+
+/**
+ * @brief Возвращает наибольший показатель степени на поле.
+ * @param b Упакованное поле.
+ * @return int показатель степени старшей плитки (0 для пустого поля).
+ */
+constexpr int maxExponent(Board b) {
+    int best = 0;
+    for (; b != 0; b >>= 4) {
+        int e = static_cast<int>(b & 0xF);
+        if (e > best) best = e;
+    }
+    return best;
+}
+
+/**
+ * @brief Выполняет ход на упакованном поле.
+ * @param b Упакованное поле.
+ * @param dir Направление хода.
+ * @param score Счёт, к которому прибавляются очки за объединения.
+ * @return Board поле после хода (равно b, если ход ничего не изменил).
+ *
+ * @code
+ * int gained = 0;
+ * Board next = moveBoard(b, Direction::Left, gained);
+ * bool moved = next != b;
+ * @endcode
+ */
+inline Board moveBoard(Board b, Direction dir, int& score) {
+    bool vertical = dir == Direction::Up || dir == Direction::Down;
+    const auto& table =
+        (dir == Direction::Left || dir == Direction::Up) ? rowTables.left : rowTables.right;
+    Board src = vertical ? transpose(b) : b;
+    Board result = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        auto row = static_cast<std::uint16_t>(src >> (16 * i));
+        result |= static_cast<Board>(table[row]) << (16 * i);
+        score += rowTables.score[row];
+    }
+    return vertical ? transpose(result) : result;
+}
+
+/**
+ * @brief Проверяет, возможно ли совершить хоть один ход.
+ * @param b Упакованное поле.
+ * @return bool true, если есть пустая ячейка или две соседние равные плитки
+ *         меньше 32768.
+ */
+constexpr bool canMoveBoard(Board b) {
+    if (occupiedMask(b) != 0x1111111111111111ULL) return true;
+    return equalPairsMask(b) != 0;
+}
+
+/**
+ * @brief Проверяет, может ли значение лежать в ячейке поля.
+ * @param value Значение плитки.
+ * @return bool true для 0 и степеней двойки от 2 до 32768.
+ */
+constexpr bool isTileValue(int value) {
+    return value == 0 ||
+           (value >= 2 && value <= 32768 && std::has_single_bit(static_cast<unsigned>(value)));
+}
+
+/**
+ * @brief Упаковывает поле из массива значений плиток.
+ * @param cells Значения плиток; каждое должно удовлетворять isTileValue().
+ * @return Board упакованное поле.
+ *
+ * Значения не проверяются; для данных извне (файлов, ввода) — tryPackBoard().
+ */
+Board packBoard(const int (&cells)[BOARD_SIZE][BOARD_SIZE]);
+
+/**
+ * @brief Упаковывает поле, проверяя значения плиток.
+ * @param cells Значения плиток.
+ * @return std::optional<Board> поле или std::nullopt, если какое-то значение
+ *         не удовлетворяет isTileValue().
+ */
+std::optional<Board> tryPackBoard(const int (&cells)[BOARD_SIZE][BOARD_SIZE]);
+
+/**
+ * @brief Распаковывает поле в массив значений плиток.
+ * @param b Упакованное поле.
+ * @param cells Массив, в который записываются значения плиток.
+ */
+void unpackBoard(Board b, int (&cells)[BOARD_SIZE][BOARD_SIZE]);
+
+#endif
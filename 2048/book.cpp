@@ -0,0 +1,142 @@
+/**
+ * @file book.cpp
+ * @brief Реализация книги ходов.
+ *
+ * Содержит определение функций, объявленных в book.h.
+ */
+
+#include "book.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "savefile.h"
+
+namespace {
+
+const char BOOK_MAGIC[8] = {'2', '0', '4', '8', 'B', 'O', 'O', 'K'};
+
+bool deeperFirst(const BookEntry& a, const BookEntry& b) {
+    return a.board != b.board ? a.board < b.board : a.depth > b.depth;
+}
+
+}
+
+OpeningBook::~OpeningBook() {
+    close();
+}
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+    if (!NATIVE_LITTLE_ENDIAN) return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(BOOK_HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    const auto* header = static_cast<const unsigned char*>(mapping);
+    auto count = readField<std::uint64_t>(header + 16);
+    bool valid = std::equal(BOOK_MAGIC, BOOK_MAGIC + 8, header) &&
+                 readField<std::uint16_t>(header + 8) == BOOK_VERSION &&
+                 readField<std::uint16_t>(header + 10) == BOARD_ENCODING &&
+                 readField<std::uint16_t>(header + 12) == sizeof(BookEntry) &&
+                 (readField<std::uint16_t>(header + 14) & ~BOOK_CANONICAL) == 0 &&
+                 readField<std::uint32_t>(header + 24) == fnv1a(header, 24) &&
+                 count == (size - BOOK_HEADER_SIZE) / sizeof(BookEntry) &&
+                 (size - BOOK_HEADER_SIZE) % sizeof(BookEntry) == 0;
+    if (!valid) {
+        ::munmap(mapping, size);
+        return false;
+    }
+    // Поиск обращается к записям вразброс.
+    ::madvise(mapping, size, MADV_RANDOM);
+
+    mapping_ = mapping;
+    mappingSize_ = size;
+    entries_ = reinterpret_cast<const BookEntry*>(header + BOOK_HEADER_SIZE);
+    count_ = count;
+    canonical_ = (readField<std::uint16_t>(header + 14) & BOOK_CANONICAL) != 0;
+    return true;
+}
+
+void OpeningBook::close() {
+    if (mapping_ != nullptr) ::munmap(mapping_, mappingSize_);
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    entries_ = nullptr;
+    count_ = 0;
+    canonical_ = false;
+}
+
+std::optional<BookEntry> OpeningBook::find(Board b) const {
+    CanonicalBoard key = canonical_ ? canonicalBoard(b) : CanonicalBoard{b, 0};
+    const BookEntry* end = entries_ + count_;
+    const BookEntry* it = std::lower_bound(
+        entries_, end, key.board,
+        [](const BookEntry& entry, Board board) { return entry.board < board; });
+    if (it == end || it->board != key.board) return std::nullopt;
+    BookEntry entry = *it;
+    entry.board = b;
+    entry.move = static_cast<std::uint8_t>(
+        inverseSymmetryDirection(static_cast<Direction>(entry.move), key.symmetry));
+    return entry;
+}
+
+bool writeBook(const std::string& path, std::vector<BookEntry>& entries, bool canonical) {
+    if (!NATIVE_LITTLE_ENDIAN) return false;
+
+    if (canonical) {
+        for (BookEntry& entry : entries) {
+            CanonicalBoard key = canonicalBoard(entry.board);
+            entry.board = key.board;
+            entry.move = static_cast<std::uint8_t>(
+                symmetryDirection(static_cast<Direction>(entry.move), key.symmetry));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), deeperFirst);
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const BookEntry& a, const BookEntry& b) {
+                                  return a.board == b.board;
+                              }),
+                  entries.end());
+
+    std::vector<unsigned char> data(BOOK_HEADER_SIZE + entries.size() * sizeof(BookEntry));
+    unsigned char* header = data.data();
+    std::copy(BOOK_MAGIC, BOOK_MAGIC + 8, header);
+    writeField<std::uint16_t>(header + 8, BOOK_VERSION);
+    writeField<std::uint16_t>(header + 10, BOARD_ENCODING);
+    writeField<std::uint16_t>(header + 12, sizeof(BookEntry));
+    writeField<std::uint16_t>(header + 14, canonical ? BOOK_CANONICAL : 0);
+    writeField<std::uint64_t>(header + 16, entries.size());
+    writeField<std::uint32_t>(header + 24, fnv1a(header, 24));
+    if (!entries.empty())
+        std::memcpy(header + BOOK_HEADER_SIZE, entries.data(), entries.size() * sizeof(BookEntry));
+    return writeFileAtomic(path, data.data(), data.size());
+}
+
+bool mergeBooks(const std::string& output, const std::vector<std::string>& inputs) {
+    std::vector<BookEntry> entries;
+    bool canonical = false;
+    for (const std::string& input : inputs) {
+        OpeningBook book;
+        if (!book.open(input)) return false;
+        entries.insert(entries.end(), book.entries(), book.entries() + book.size());
+        canonical = canonical || book.canonical();
+    }
+    // Канонические записи не меняются при повторном приведении.
+    return writeBook(output, entries, canonical);
+}
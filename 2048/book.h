@@ -0,0 +1,159 @@
+/**
+ * @file book.h
+ * @brief Книга ходов: результаты поиска для частых позиций, отображаемые в память.
+ *
+ * Файл — заголовок и отсортированный по полю массив записей
+ * фиксированного размера (все числа — little-endian):
+ *
+ * | Смещение | Размер | Поле                                      |
+ * |----------|--------|-------------------------------------------|
+ * | 0        | 8      | сигнатура "2048BOOK"                      |
+ * | 8        | 2      | версия формата                            |
+ * | 10       | 2      | версия упаковки поля (BOARD_ENCODING)     |
+ * | 12       | 2      | размер записи (16)                        |
+ * | 14       | 2      | флаги (BOOK_CANONICAL)                    |
+ * | 16       | 8      | количество записей                        |
+ * | 24       | 4      | FNV-1a по байтам 0..23                    |
+ * | 28       | 4      | зарезервировано (0)                       |
+ * | 32       | 16 * n | записи BookEntry                          |
+ *
+ * Файл отображается в память целиком и не разбирается: поиск — двоичный
+ * поиск прямо по отображённым записям, поэтому обращение к книге стоит
+ * нескольких страниц, а не поиска expectimax.
+ *
+ * В книге с флагом BOOK_CANONICAL поля записей приведены к канонической
+ * форме (см. canonicalBoard()), а ходы — к ходам на каноническом поле:
+ * одна запись отвечает всем восьми симметричным позициям. Это верно,
+ * только если книга построена с симметричной оценкой.
+ */
+
+#ifndef GAME_2048_BOOK_H
+#define GAME_2048_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * @brief Версия формата книги.
+ */
+const std::uint16_t BOOK_VERSION = 1;
+
+/**
+ * @brief Размер заголовка книги в байтах.
+ */
+const std::size_t BOOK_HEADER_SIZE = 32;
+
+/**
+ * @brief Флаг заголовка: записи хранятся под каноническими полями.
+ */
+const std::uint16_t BOOK_CANONICAL = 1;
+
+/**
+ * @brief Запись книги: лучший ход из позиции.
+ */
+struct BookEntry {
+    Board board = 0;            ///< Упакованное поле.
+    float value = 0.0f;         ///< Ожидаемая оценка лучшего хода.
+    std::uint8_t move = 0;      ///< Лучший ход (Direction).
+    std::uint8_t depth = 0;     ///< Глубина поиска, давшего результат.
+    std::uint16_t reserved = 0; ///< Зарезервировано (0).
+};
+
+static_assert(sizeof(BookEntry) == 16, "book records are 16 bytes on disk");
+
+/**
+ * @brief Книга, отображённая в память только для чтения.
+ *
+ * @code
+ * OpeningBook book;
+ * if (book.open("openings.book"))
+ *     if (auto entry = book.find(game.board())) game.move(static_cast<Direction>(entry->move));
+ * @endcode
+ */
+class OpeningBook {
+public:
+    OpeningBook() = default;
+
+    /** @brief Снимает отображение. */
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    /**
+     * @brief Отображает файл книги в память.
+     * @param path Файл книги.
+     * @return bool false, если файла нет, он повреждён или другой версии.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Снимает отображение.
+     * @return void
+     */
+    void close();
+
+    /**
+     * @brief Ищет позицию.
+     * @param b Упакованное поле.
+     * @return std::optional<BookEntry> запись или std::nullopt.
+     *
+     * В канонической книге ищется каноническое поле, а в возвращённой
+     * записи поле и ход приведены обратно к b.
+     */
+    std::optional<BookEntry> find(Board b) const;
+
+    /**
+     * @brief Хранятся ли записи под каноническими полями (BOOK_CANONICAL).
+     * @return bool true для канонической книги.
+     */
+    bool canonical() const { return canonical_; }
+
+    /**
+     * @brief Количество записей.
+     * @return std::size_t число записей (0, если книга не открыта).
+     */
+    std::size_t size() const { return count_; }
+
+    /**
+     * @brief Записи книги в порядке возрастания поля.
+     * @return const BookEntry* начало массива записей.
+     */
+    const BookEntry* entries() const { return entries_; }
+
+private:
+    void* mapping_ = nullptr;
+    std::size_t mappingSize_ = 0;
+    const BookEntry* entries_ = nullptr;
+    std::size_t count_ = 0;
+    bool canonical_ = false;
+};
+
+/**
+ * @brief Записывает книгу атомарно (см. writeFileAtomic()).
+ * @param path Файл книги.
+ * @param entries Записи в любом порядке; сортируются на месте.
+ * @param canonical true — привести записи к каноническим полям и
+ *        записать книгу с флагом BOOK_CANONICAL.
+ * @return bool true, если файл записан.
+ *
+ * Из записей с одинаковым полем остаётся запись с наибольшей глубиной.
+ */
+bool writeBook(const std::string& path, std::vector<BookEntry>& entries, bool canonical = false);
+
+/**
+ * @brief Объединяет несколько книг в одну.
+ * @param output Файл результата.
+ * @param inputs Исходные книги.
+ * @return bool false, если какую-то книгу не удалось открыть или записать результат.
+ *
+ * Результат канонический, если каноническая хотя бы одна из книг.
+ */
+bool mergeBooks(const std::string& output, const std::vector<std::string>& inputs);
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file eval.cpp
+ * @brief Построение таблицы оценок линий.
+ *
+ * Содержит определение функций, объявленных в eval.h.
+ */
+
+#include "eval.h"
+
+#include <bit>
+#include <charconv>
+
+namespace {
+
+struct WeightName {
+    std::string_view name;
+    float EvalWeights::*weight;
+};
+
+const WeightName WEIGHT_NAMES[] = {
+    {"base", &EvalWeights::base},
+    {"empty", &EvalWeights::empty},
+    {"pairs", &EvalWeights::pairs},
+    {"merges", &EvalWeights::merges},
+    {"gradient", &EvalWeights::gradient},
+    {"corner", &EvalWeights::corner},
+    {"monotonicity", &EvalWeights::monotonicity},
+    {"smoothness", &EvalWeights::smoothness},
+};
+
+int occupiedCells(std::uint16_t line) {
+    return std::popcount(static_cast<std::uint16_t>(occupiedMask(line)));
+}
+
+float scoreLine(std::uint16_t line, const EvalWeights& w) {
+    int cells[BOARD_SIZE];
+    for (int k = 0; k < BOARD_SIZE; ++k) cells[k] = (line >> (4 * k)) & 0xF;
+
+    int empty = 0;
+    int pairs = 0;
+    int gradient = 0;
+    int increase = 0;
+    int decrease = 0;
+    for (int k = 0; k < BOARD_SIZE; ++k) {
+        if (cells[k] == 0) ++empty;
+        gradient += cells[k] * (BOARD_SIZE - 1 - k);
+        if (k + 1 == BOARD_SIZE) continue;
+        if (cells[k] != 0 && cells[k] == cells[k + 1]) ++pairs;
+        if (cells[k + 1] > cells[k]) increase += cells[k + 1] - cells[k];
+        else decrease += cells[k] - cells[k + 1];
+    }
+    int corner = cells[0] + cells[BOARD_SIZE - 1];
+    int monotonicity = -(increase < decrease ? increase : decrease);
+
+    // Плавность — по непустым плиткам, которые окажутся рядом после сдвига.
+    int smoothness = 0;
+    int previous = 0;
+    for (int cell : cells) {
+        if (cell == 0) continue;
+        if (previous != 0) smoothness -= cell > previous ? cell - previous : previous - cell;
+        previous = cell;
+    }
+
+    // Каждое объединение убирает одну плитку из линии.
+    int merges = occupiedCells(line) - occupiedCells(rowTables.left[line]);
+
+    return 0.5f * w.empty * static_cast<float>(empty) + w.pairs * static_cast<float>(pairs) +
+           w.merges * static_cast<float>(merges) + w.gradient * static_cast<float>(gradient) +
+           w.corner * static_cast<float>(corner) +
+           w.monotonicity * static_cast<float>(monotonicity) +
+           w.smoothness * static_cast<float>(smoothness);
+}
+
+}
+
+bool parseEvalWeights(std::string_view spec, EvalWeights& weights) {
+    EvalWeights parsed = weights;
+    while (!spec.empty()) {
+        std::size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+
+        std::size_t eq = item.find('=');
+        if (eq == std::string_view::npos) return false;
+        std::string_view name = item.substr(0, eq);
+        std::string_view value = item.substr(eq + 1);
+
+        float* target = nullptr;
+        for (const WeightName& entry : WEIGHT_NAMES)
+            if (entry.name == name) target = &(parsed.*entry.weight);
+        if (target == nullptr) return false;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), *target);
+        if (error != std::errc{} || end != value.data() + value.size()) return false;
+    }
+    weights = parsed;
+    return true;
+}
+
+BoardEvaluator::BoardEvaluator(const EvalWeights& weights) : lines_(65536) {
+    setWeights(weights);
+}
+
+void BoardEvaluator::setWeights(const EvalWeights& weights) {
+    weights_ = weights;
+    for (int r = 0; r < 65536; ++r)
+        lines_[static_cast<std::size_t>(r)] = scoreLine(static_cast<std::uint16_t>(r), weights_);
+
+    symmetric_ = true;
+    for (std::size_t r = 0; r < lines_.size() && symmetric_; ++r) {
+        std::size_t reversed =
+            ((r & 0xF) << 12) | ((r & 0xF0) << 4) | ((r >> 4) & 0xF0) | (r >> 12);
+        symmetric_ = lines_[r] == lines_[reversed];
+    }
+}
+
+const BoardEvaluator& defaultEvaluator() {
+    static const BoardEvaluator evaluator;
+    return evaluator;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file eval.h
+ * @brief Табличная статическая оценка упакованного поля.
+ *
+ * Каждый признак оценки считается по одной линии из четырёх ячеек,
+ * поэтому оценка линии зависит только от её 16-битной кодировки.
+ * BoardEvaluator заранее вычисляет взвешенную оценку всех 65536 линий,
+ * а поле оценивается восемью обращениями к таблице: четыре строки и
+ * четыре столбца (строки транспонированного поля, как в moveBoard()).
+ *
+ * Признаки линии:
+ * - empty — пустые ячейки (каждая ячейка входит в строку и столбец,
+ *   поэтому в таблицу идёт половина веса);
+ * - pairs — соседние равные непустые плитки;
+ * - merges — объединения при сдвиге линии влево по правилам moveLeft();
+ * - gradient — показатель плитки, умноженный на расстояние до дальнего
+ *   конца линии (3, 2, 1, 0); по строкам и столбцам вместе это вес
+ *   6 - i - j, наибольший в левом верхнем углу;
+ * - corner — показатели плиток на концах линии; угловые ячейки
+ *   получают этот вес дважды, краевые — один раз, центральные — ни разу;
+ * - monotonicity — минус меньшая из сумм возрастаний и убываний
+ *   показателей вдоль линии (0 для монотонной линии);
+ * - smoothness — минус сумма модулей разностей показателей соседних
+ *   непустых плиток (пустые ячейки пропускаются).
+ *
+ * Веса по умолчанию повторяют прежнюю оценку evaluateBoard().
+ */
+
+#ifndef GAME_2048_EVAL_H
+#define GAME_2048_EVAL_H
+
+#include <string_view>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * @brief Веса признаков оценки.
+ */
+struct EvalWeights {
+    float base = 1000.0f;           ///< Постоянная часть оценки.
+    float empty = 270.0f;           ///< За пустую ячейку.
+    float pairs = 700.0f;           ///< За пару соседних равных плиток.
+    float merges = 0.0f;            ///< За объединение при сдвиге линии.
+    float gradient = 10.0f;         ///< За показатель, взвешенный к углу.
+    float corner = 0.0f;            ///< За показатель на конце линии.
+    float monotonicity = 0.0f;      ///< За монотонность линии.
+    float smoothness = 0.0f;        ///< За плавность линии.
+};
+
+/**
+ * @brief Разбирает веса из строки вида "empty=270,pairs=700,smoothness=5".
+ * @param spec Пары имя=значение через запятую; пропущенные веса не меняются.
+ * @param weights Веса, которые изменяются.
+ * @return bool false при неизвестном имени или неверном числе.
+ */
+bool parseEvalWeights(std::string_view spec, EvalWeights& weights);
+
+/**
+ * @brief Оценка поля по таблице оценок линий.
+ *
+ * evaluate() только читает таблицу, поэтому один экземпляр можно
+ * использовать из нескольких потоков; setWeights() перестраивает
+ * таблицу и не должна выполняться одновременно с evaluate().
+ *
+ * @code
+ * EvalWeights weights;
+ * weights.smoothness = 5.0f;
+ * BoardEvaluator evaluator(weights);
+ * float value = evaluator.evaluate(game.board());
+ * @endcode
+ */
+class BoardEvaluator {
+public:
+    /**
+     * @brief Строит таблицу для заданных весов.
+     * @param weights Веса признаков.
+     */
+    explicit BoardEvaluator(const EvalWeights& weights = {});
+
+    /**
+     * @brief Заменяет веса и перестраивает таблицу.
+     * @param weights Веса признаков.
+     * @return void
+     */
+    void setWeights(const EvalWeights& weights);
+
+    /**
+     * @brief Текущие веса.
+     * @return const EvalWeights& веса.
+     */
+    const EvalWeights& weights() const { return weights_; }
+
+    /**
+     * @brief Оценка одной линии без постоянной части.
+     * @param encoded Линия: четыре показателя по 4 бита, младшие — первая ячейка.
+     * @return float взвешенная сумма признаков линии.
+     */
+    float line(std::uint16_t encoded) const { return lines_[encoded]; }
+
+    /**
+     * @brief Не меняется ли оценка при поворотах и отражениях поля.
+     * @return bool true, если оценка каждой линии равна оценке перевёрнутой линии.
+     *
+     * Тогда симметричные поля (см. canonicalBoard()) получают одну оценку
+     * с точностью до порядка сложения, и кэши поиска могут хранить их
+     * под одним ключом. Признак gradient несимметричен.
+     */
+    bool symmetric() const { return symmetric_; }
+
+    /**
+     * @brief Оценивает поле.
+     * @param b Упакованное поле.
+     * @return float оценка (больше — лучше), не меньше 0.
+     *
+     * Отрицательная сумма заменяется нулём: 0 — оценка проигранной
+     * позиции в поиске, и живая позиция не должна быть хуже неё.
+     */
+    float evaluate(Board b) const {
+        Board t = transpose(b);
+        float value = weights_.base;
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            value += lines_[static_cast<std::uint16_t>(b >> (16 * i))];
+            value += lines_[static_cast<std::uint16_t>(t >> (16 * i))];
+        }
+        return value > 0.0f ? value : 0.0f;
+    }
+
+private:
+    EvalWeights weights_;
+    std::vector<float> lines_;
+    bool symmetric_ = false;
+};
+
+/**
+ * @brief Оценщик с весами по умолчанию, общий для всей программы.
+ * @return const BoardEvaluator& оценщик.
+ */
+const BoardEvaluator& defaultEvaluator();
+
+#endif
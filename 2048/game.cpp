@@ -0,0 +1,129 @@
+/**
+ * @file game.cpp
+ * @brief Реализация класса Game.
+ *
+ * Содержит определение функций, объявленных в game.h.
+ */
+
+#include "game.h"
+#include "history.h"
+#include "profile.h"
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <vector>
+
+Game::Game() : rng_(std::random_device{}()) {}
+
+Game::Game(std::uint64_t seed) : rng_(seed) {}
+
+void Game::startNew() {
+    score_ = 0;
+    setBoard(0);
+    generateNumber();
+    generateNumber();
+}
+
+bool Game::move(Direction dir) {
+    PROFILE_SCOPE(Move);
+    Board before = board_;
+    board_ = moveBoard(board_, dir, score_);
+    if (board_ == before) return false;
+    refreshSummary();
+    return true;
+}
+
+bool Game::move(char dir) {
+    auto d = directionFromChar(dir);
+    return d ? move(*d) : false;
+}
+
+void Game::generateNumber() {
+    PROFILE_SCOPE(GenerateNumber);
+    int empty = std::popcount(emptyCells_);
+    if (empty == 0) return;
+
+    auto k = static_cast<int>(rng_.below(static_cast<std::uint32_t>(empty)));
+    Board exponent = rng_.below(10) < 9 ? 1 : 2;
+    int shift = nthSetBit(emptyCells_, k);
+    board_ |= exponent << shift;
+    emptyCells_ &= ~(Board{1} << shift);
+    mergeable_ = mergeable_ || matchesNeighbor(board_, shift);
+}
+
+bool Game::load(const std::string& path, History* history) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    SaveRecord record;
+    if (history == nullptr) {
+        // Блок истории после записи, если он есть, не читается.
+        unsigned char buffer[SAVE_RECORD_SIZE];
+        in.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+        if (!decodeSaveRecord(buffer, static_cast<std::size_t>(in.gcount()), record)) return false;
+        restore(record);
+        return true;
+    }
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)),
+                                    std::istreambuf_iterator<char>());
+    if (data.size() < SAVE_RECORD_SIZE || !decodeSaveRecord(data.data(), SAVE_RECORD_SIZE, record))
+        return false;
+    restore(record);
+    history->decode(data.data() + SAVE_RECORD_SIZE, data.size() - SAVE_RECORD_SIZE);
+    return true;
+}
+
+bool Game::loadText(const std::string& savePath, const std::string& bestPath) {
+    std::ifstream in(savePath);
+    if (!in.is_open()) return false;
+
+    int cells[BOARD_SIZE][BOARD_SIZE];
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            if (!(in >> cells[i][j])) return false;
+
+    int loadedScore;
+    if (!(in >> loadedScore)) return false;
+    in.close();
+
+    std::optional<Board> loaded = tryPackBoard(cells);
+    if (!loaded) return false;
+    setBoard(*loaded);
+    score_ = loadedScore;
+
+    std::ifstream bestIn(bestPath);
+    if (bestIn.is_open()) {
+        bestIn >> bestScore_;
+        bestIn.close();
+    }
+
+    return true;
+}
+
+bool Game::save(const std::string& path, const History* history) {
+    if (score_ > bestScore_) bestScore_ = score_;
+    auto bytes = encodeSaveRecord(snapshot());
+    if (history == nullptr) return writeFileAtomic(path, bytes.data(), bytes.size());
+    std::vector<unsigned char> data(bytes.begin(), bytes.end());
+    history->encode(data);
+    return writeFileAtomic(path, data.data(), data.size());
+}
+
+SaveRecord Game::snapshot() const {
+    return {board_, score_, bestScore_, rng_.state()};
+}
+
+void Game::restore(const SaveRecord& record) {
+    setBoard(record.board);
+    score_ = record.score;
+    bestScore_ = record.bestScore;
+    rng_.setState(record.rng);
+}
+
+Game& defaultGame() {
+    static Game game;
+    return game;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file game.h
+ * @brief Состояние одной партии 2048.
+ *
+ * Класс Game владеет полем, счётом, лучшим счётом и генератором
+ * случайных чисел, поэтому несколько партий могут идти одновременно,
+ * в том числе в разных потоках, без общих изменяемых данных.
+ * Свободные функции из 2048.h работают поверх экземпляра defaultGame().
+ */
+
+#ifndef GAME_2048_GAME_H
+#define GAME_2048_GAME_H
+
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "rng.h"
+#include "savefile.h"
+
+class History;
+
+/**
+ * @brief Одна партия 2048.
+ *
+ * @code
+ * Game game(42);
+ * game.startNew();
+ * while (game.canMove()) {
+ *     if (game.move(Direction::Left))
+ *         game.generateNumber();
+ * }
+ * @endcode
+ */
+class Game {
+public:
+    /**
+     * @brief Создаёт партию с генератором, инициализированным из std::random_device.
+     */
+    Game();
+
+    /**
+     * @brief Создаёт партию с заданным зерном генератора.
+     * @param seed Зерно генератора случайных чисел.
+     *
+     * Одинаковое зерно и одинаковая последовательность ходов
+     * всегда дают одинаковую партию.
+     */
+    explicit Game(std::uint64_t seed);
+
+    /**
+     * @brief Очищает поле, сбрасывает счёт и размещает два числа.
+     * @return void
+     */
+    void startNew();
+
+    /**
+     * @brief Выполняет ход в заданном направлении.
+     * @param dir Направление хода.
+     * @return bool true, если поле изменилось.
+     */
+    bool move(Direction dir);
+
+    /**
+     * @brief Выполняет ход по символу клавиши.
+     * @param dir Символ направления: 'w', 'a', 's' или 'd'.
+     * @return bool true, если поле изменилось; false и для неизвестного символа.
+     */
+    bool move(char dir);
+
+    /**
+     * @brief Добавляет на случайную пустую ячейку число 2 (90%) или 4 (10%).
+     * @return void
+     */
+    void generateNumber();
+
+    /**
+     * @brief Проверяет, возможно ли совершить хоть один ход.
+     * @return bool true, если можно сделать ход.
+     *
+     * Не просматривает поле: маска пустых ячеек и признак возможного
+     * объединения обновляются в move(), generateNumber() и setBoard().
+     */
+    bool canMove() const { return emptyCells_ != 0 || mergeable_; }
+
+    /**
+     * @brief Маска пустых ячеек (см. emptyMask()).
+     * @return Board бит 4k установлен, если ячейка k пуста.
+     */
+    Board emptyCells() const { return emptyCells_; }
+
+    /**
+     * @brief Загружает партию из двоичного сохранения (см. savefile.h) одним чтением.
+     * @param path Файл сохранения.
+     * @param history История, читаемая из блока после записи (см. history.h);
+     *        если блока нет или он повреждён, история пуста.
+     * @return bool true, если файл прочитан и запись корректна.
+     */
+    bool load(const std::string& path, History* history = nullptr);
+
+    /**
+     * @brief Загружает партию из сохранения старого текстового формата.
+     * @param savePath Файл с полем и счётом.
+     * @param bestPath Файл с лучшим счётом.
+     * @return bool true, если удалось загрузить поле и счёт; поле с
+     *         недопустимыми значениями плиток не загружается.
+     */
+    bool loadText(const std::string& savePath, const std::string& bestPath);
+
+    /**
+     * @brief Атомарно сохраняет партию в двоичном формате.
+     * @param path Файл сохранения.
+     * @param history История, записываемая блоком после записи (см. history.h).
+     * @return bool true, если файл записан.
+     *
+     * Лучший счёт обновляется, если текущий счёт его превысил.
+     */
+    bool save(const std::string& path, const History* history = nullptr);
+
+    /**
+     * @brief Снимок состояния партии для сохранения.
+     * @return SaveRecord поле, счёт, лучший счёт и состояние генератора.
+     */
+    SaveRecord snapshot() const;
+
+    /**
+     * @brief Восстанавливает состояние партии из снимка.
+     * @param record Снимок.
+     * @return void
+     */
+    void restore(const SaveRecord& record);
+
+    /** @brief Упакованное поле. */
+    Board board() const { return board_; }
+    /** @brief Заменяет поле. */
+    void setBoard(Board b) {
+        board_ = b;
+        refreshSummary();
+    }
+    /** @brief Текущий счёт. */
+    int score() const { return score_; }
+    /** @brief Заменяет текущий счёт. */
+    void setScore(int s) { score_ = s; }
+    /** @brief Лучший счёт. */
+    int bestScore() const { return bestScore_; }
+    /** @brief Заменяет лучший счёт. */
+    void setBestScore(int s) { bestScore_ = s; }
+    /** @brief Генератор случайных чисел партии. */
+    Rng& rng() { return rng_; }
+    /** @brief Генератор случайных чисел партии. */
+    const Rng& rng() const { return rng_; }
+
+private:
+    void refreshSummary() {
+        emptyCells_ = emptyMask(board_);
+        mergeable_ = hasMergeablePair(board_);
+    }
+
+    Board board_ = 0;
+    Board emptyCells_ = emptyMask(0);
+    bool mergeable_ = false;
+    int score_ = 0;
+    int bestScore_ = 0;
+    Rng rng_;
+};
+
+/**
+ * @brief Экземпляр партии, с которым работают свободные функции из 2048.h.
+ * @return Game& партия по умолчанию.
+ */
+Game& defaultGame();
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ * @file generic_board.h
+ * @brief Поле произвольного размера NxN (от 3x3 до 8x8), заданного при компиляции.
+ *
+ * Для всех размеров используется одно ядро сдвига и объединения
+ * slideLine(); направление задаётся таблицей индексов ячеек каждой
+ * линии, которая строится на этапе компиляции. Поле 4x4
+ * специализировано поверх упакованного представления из board.h
+ * и табличных ходов moveBoard().
+ *
+ * Таблицы строк для 4x4 (65536 записей) строятся при запуске, а не
+ * constexpr: их вычисление на этапе компиляции превышает пределы
+ * компилятора. Для N >= 5 строки не помещаются в таблицу вовсе.
+ */
+
+#ifndef GAME_2048_GENERIC_BOARD_H
+#define GAME_2048_GENERIC_BOARD_H
+
+#include <array>
+#include <cstdint>
+
+#include "board.h"
+#include "rng.h"
+
+/**
+ * @brief Наибольший показатель степени для полей произвольного размера.
+ *
+ * Плитки 2^30 не объединяются, чтобы счёт оставался в int.
+ */
+const int GENERIC_MAX_EXPONENT = 30;
+
+/**
+ * @brief Сдвигает линию к началу и объединяет равные соседние плитки.
+ * @tparam N Длина линии.
+ * @param line Показатели степеней; line[0] — край, к которому идёт сдвиг.
+ * @param points Счёт, к которому прибавляются очки за объединения.
+ * @return bool true, если линия изменилась.
+ *
+ * Те же правила, что и в moveLeft(): каждая плитка объединяется не более
+ * одного раза за ход.
+ */
+template <std::size_t N>
+constexpr bool slideLine(std::array<std::uint8_t, N>& line, int& points) {
+    std::array<std::uint8_t, N> temp{};
+    std::size_t idx = 0;
+    for (std::uint8_t cell : line) {
+        if (cell == 0) continue;
+        if (temp[idx] == 0) {
+            temp[idx] = cell;
+        } else if (temp[idx] == cell && cell < GENERIC_MAX_EXPONENT) {
+            ++temp[idx++];
+            points += 1 << (cell + 1);
+        } else {
+            if (++idx < N)
+                temp[idx] = cell;
+        }
+    }
+    bool changed = temp != line;
+    line = temp;
+    return changed;
+}
+
+/**
+ * @brief Индексы ячеек каждой линии для каждого направления.
+ * @tparam N Размер поля.
+ *
+ * lines[dir][l][k] — номер ячейки (N * строка + столбец), которая стоит
+ * k-й от края в линии l при ходе dir.
+ */
+template <std::size_t N>
+struct LineTables {
+    std::array<std::array<std::array<std::uint8_t, N>, N>, 4> lines{};
+
+    constexpr LineTables() {
+        for (std::size_t l = 0; l < N; ++l)
+            for (std::size_t k = 0; k < N; ++k) {
+                lines[static_cast<std::size_t>(Direction::Up)][l][k] = index(k, l);
+                lines[static_cast<std::size_t>(Direction::Left)][l][k] = index(l, k);
+                lines[static_cast<std::size_t>(Direction::Down)][l][k] = index(N - 1 - k, l);
+                lines[static_cast<std::size_t>(Direction::Right)][l][k] = index(l, N - 1 - k);
+            }
+    }
+
+private:
+    static constexpr std::uint8_t index(std::size_t row, std::size_t col) {
+        return static_cast<std::uint8_t>(N * row + col);
+    }
+};
+
+/**
+ * @brief Поле NxN с показателями степеней в байтах.
+ * @tparam N Размер поля, от 3 до 8.
+ *
+ * @code
+ * GenericBoard<5> b;
+ * Rng rng(1);
+ * b.spawn(rng);
+ * int points = 0;
+ * if (b.move(Direction::Left, points)) b.spawn(rng);
+ * @endcode
+ */
+template <int N>
+class GenericBoard {
+    static_assert(N >= 3 && N <= 8, "supported board sizes are 3x3 to 8x8");
+
+    static constexpr auto LEN = static_cast<std::size_t>(N);
+
+public:
+    /** @brief Размер поля. */
+    static constexpr int size = N;
+
+    /** @brief Показатель степени в ячейке (0 — пусто). */
+    constexpr int exponent(int row, int col) const {
+        return cells_[static_cast<std::size_t>(N * row + col)];
+    }
+
+    /** @brief Записывает показатель степени в ячейку. */
+    constexpr void setExponent(int row, int col, int e) {
+        cells_[static_cast<std::size_t>(N * row + col)] = static_cast<std::uint8_t>(e);
+    }
+
+    /**
+     * @brief Выполняет ход.
+     * @param dir Направление хода.
+     * @param points Счёт, к которому прибавляются очки.
+     * @return bool true, если поле изменилось.
+     */
+    constexpr bool move(Direction dir, int& points) {
+        constexpr LineTables<LEN> tables;
+        const auto& lines = tables.lines[static_cast<std::size_t>(dir)];
+        bool moved = false;
+        for (const auto& indices : lines) {
+            std::array<std::uint8_t, LEN> line{};
+            for (std::size_t k = 0; k < LEN; ++k)
+                line[k] = cells_[indices[k]];
+            if (!slideLine<LEN>(line, points)) continue;
+            moved = true;
+            for (std::size_t k = 0; k < LEN; ++k)
+                cells_[indices[k]] = line[k];
+        }
+        return moved;
+    }
+
+    /** @brief Есть ли пустая ячейка или пара равных соседей. */
+    constexpr bool canMove() const {
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) {
+                int e = exponent(i, j);
+                if (e == 0) return true;
+                if (e == GENERIC_MAX_EXPONENT) continue;
+                if (i + 1 < N && e == exponent(i + 1, j)) return true;
+                if (j + 1 < N && e == exponent(i, j + 1)) return true;
+            }
+        return false;
+    }
+
+    /** @brief Количество пустых ячеек. */
+    constexpr int countEmpty() const {
+        int empty = 0;
+        for (std::uint8_t cell : cells_)
+            empty += cell == 0;
+        return empty;
+    }
+
+    /** @brief Наибольший показатель степени на поле. */
+    constexpr int maxExponent() const {
+        int best = 0;
+        for (std::uint8_t cell : cells_)
+            if (cell > best) best = cell;
+        return best;
+    }
+
+    /**
+     * @brief Добавляет 2 (90%) или 4 (10%) в случайную пустую ячейку.
+     * @param rng Генератор партии.
+     * @return void
+     */
+    void spawn(Rng& rng) {
+        int empty = countEmpty();
+        if (empty == 0) return;
+        auto k = static_cast<int>(rng.below(static_cast<std::uint32_t>(empty)));
+        auto value = static_cast<std::uint8_t>(rng.below(10) < 9 ? 1 : 2);
+        for (std::uint8_t& cell : cells_)
+            if (cell == 0 && k-- == 0) {
+                cell = value;
+                return;
+            }
+    }
+
+    /** @brief Поля равны. */
+    friend constexpr bool operator==(const GenericBoard&, const GenericBoard&) = default;
+
+private:
+    std::array<std::uint8_t, LEN * LEN> cells_{};
+};
+
+/**
+ * @brief Поле 4x4 поверх упакованного Board и таблиц строк.
+ */
+template <>
+class GenericBoard<4> {
+public:
+    /** @brief Размер поля. */
+    static constexpr int size = 4;
+
+    /** @brief Показатель степени в ячейке (0 — пусто). */
+    constexpr int exponent(int row, int col) const { return cellExponent(board_, row, col); }
+
+    /** @brief Записывает показатель степени в ячейку. */
+    constexpr void setExponent(int row, int col, int e) { board_ = withCell(board_, row, col, e); }
+
+    /** @brief Выполняет ход четырьмя обращениями к таблицам строк. */
+    bool move(Direction dir, int& points) {
+        Board before = board_;
+        board_ = moveBoard(board_, dir, points);
+        return board_ != before;
+    }
+
+    /** @brief Есть ли пустая ячейка или пара равных соседей. */
+    constexpr bool canMove() const { return canMoveBoard(board_); }
+
+    /** @brief Количество пустых ячеек. */
+    constexpr int countEmpty() const { return ::countEmpty(board_); }
+
+    /** @brief Наибольший показатель степени на поле. */
+    constexpr int maxExponent() const { return ::maxExponent(board_); }
+
+    /** @brief Добавляет 2 (90%) или 4 (10%) в случайную пустую ячейку. */
+    void spawn(Rng& rng) {
+        int empty = countEmpty();
+        if (empty == 0) return;
+        auto k = static_cast<int>(rng.below(static_cast<std::uint32_t>(empty)));
+        Board value = rng.below(10) < 9 ? 1 : 2;
+        board_ |= value << nthEmptyShift(board_, k);
+    }
+
+    /** @brief Упакованное поле. */
+    constexpr Board packed() const { return board_; }
+
+    /** @brief Поля равны. */
+    friend constexpr bool operator==(const GenericBoard&, const GenericBoard&) = default;
+
+private:
+    Board board_ = 0;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file history.cpp
+ * @brief Реализация истории партии.
+ *
+ * Содержит определение функций, объявленных в history.h.
+ */
+
+#include "history.h"
+#include "savefile.h"
+
+#include <algorithm>
+
+namespace {
+
+const unsigned char HISTORY_MAGIC[4] = {'H', 'I', 'S', 'T'};
+const std::size_t HISTORY_HEADER_SIZE = 16;
+const std::size_t HISTORY_ENTRY_SIZE = 44;
+
+void apply(const HistoryEntry& entry, Game& game) {
+    game.setBoard(entry.board);
+    game.setScore(entry.score);
+    game.rng().setState(entry.rng);
+}
+
+}
+
+History::History(std::size_t depth) : slots_(depth + 1) {}
+
+HistoryEntry History::capture(const Game& game) {
+    return {game.board(), game.score(), game.rng().state()};
+}
+
+void History::record(const HistoryEntry& before) {
+    if (cursor_ == depth()) {
+        if (cursor_ == 0) return;
+        begin_ = (begin_ + 1) % slots_.size();
+        --cursor_;
+    }
+    at(cursor_) = before;
+    ++cursor_;
+    size_ = cursor_;
+}
+
+bool History::seek(std::size_t position, Game& game) {
+    if (position >= size_) return false;
+    if (position == cursor_) return true;
+    at(cursor_) = capture(game);
+    if (cursor_ == size_) ++size_;
+    cursor_ = position;
+    apply(at(cursor_), game);
+    return true;
+}
+
+void History::clear() {
+    begin_ = 0;
+    size_ = 0;
+    cursor_ = 0;
+}
+
+void History::encode(std::vector<unsigned char>& out) const {
+    std::size_t start = out.size();
+    out.resize(start + HISTORY_HEADER_SIZE + size_ * HISTORY_ENTRY_SIZE + 4);
+    unsigned char* p = out.data() + start;
+    std::copy(HISTORY_MAGIC, HISTORY_MAGIC + 4, p);
+    putLE(p + 4, HISTORY_VERSION, 2);
+    putLE(p + 6, 0, 2);
+    putLE(p + 8, size_, 4);
+    putLE(p + 12, cursor_, 4);
+    unsigned char* q = p + HISTORY_HEADER_SIZE;
+    for (std::size_t k = 0; k < size_; ++k, q += HISTORY_ENTRY_SIZE) {
+        const HistoryEntry& entry = slots_[(begin_ + k) % slots_.size()];
+        putLE(q, entry.board, 8);
+        putLE(q + 8, static_cast<std::uint32_t>(entry.score), 4);
+        for (int w = 0; w < 4; ++w)
+            putLE(q + 12 + 8 * w, entry.rng[static_cast<std::size_t>(w)], 8);
+    }
+    putLE(q, fnv1a(p, static_cast<std::size_t>(q - p)), 4);
+}
+
+bool History::decode(const unsigned char* data, std::size_t size) {
+    clear();
+    if (size < HISTORY_HEADER_SIZE + 4) return false;
+    if (!std::equal(HISTORY_MAGIC, HISTORY_MAGIC + 4, data)) return false;
+    if (getLE(data + 4, 2) != HISTORY_VERSION) return false;
+    std::uint64_t count = getLE(data + 8, 4);
+    std::uint64_t cursor = getLE(data + 12, 4);
+    if (cursor > count || size != HISTORY_HEADER_SIZE + count * HISTORY_ENTRY_SIZE + 4) return false;
+    if (getLE(data + size - 4, 4) != fnv1a(data, size - 4)) return false;
+
+    // Если буфер меньше, отбрасываются самые старые снимки, а затем
+    // лишние снимки для повтора.
+    std::uint64_t skip = cursor > depth() ? cursor - depth() : 0;
+    count = std::min<std::uint64_t>(count, skip + slots_.size());
+    const unsigned char* q = data + HISTORY_HEADER_SIZE + skip * HISTORY_ENTRY_SIZE;
+    for (std::uint64_t k = skip; k < count; ++k, q += HISTORY_ENTRY_SIZE) {
+        HistoryEntry& entry = slots_[size_++];
+        entry.board = getLE(q, 8);
+        entry.score = static_cast<int>(static_cast<std::uint32_t>(getLE(q + 8, 4)));
+        for (int w = 0; w < 4; ++w)
+            entry.rng[static_cast<std::size_t>(w)] = getLE(q + 12 + 8 * w, 8);
+    }
+    cursor_ = cursor - skip;
+    return true;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file history.h
+ * @brief История партии для отмены и повтора ходов.
+ *
+ * Кольцевой буфер снимков фиксированной ёмкости: поле, счёт и состояние
+ * генератора до каждого хода. Память выделяется один раз в конструкторе,
+ * record(), undo(), redo() и seek() выполняются за O(1) и ничего не
+ * выделяют. Когда буфер заполнен, новый ход вытесняет самый старый
+ * снимок. Снимок хранит и генератор, поэтому после отмены тот же ход
+ * даёт то же появившееся число.
+ *
+ * История сохраняется вслед за записью сохранения (см. savefile.h)
+ * блоком (все числа — little-endian): сигнатура "HIST", версия u16,
+ * резерв u16, число снимков u32, позиция текущего снимка u32, снимки
+ * по 44 байта (поле u64, счёт u32, генератор 4 x u64) и FNV-1a по
+ * всем предыдущим байтам блока.
+ */
+
+#ifndef GAME_2048_HISTORY_H
+#define GAME_2048_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+#include "game.h"
+#include "rng.h"
+
+/**
+ * @brief Версия блока истории.
+ */
+const std::uint16_t HISTORY_VERSION = 1;
+
+/**
+ * @brief Глубина отмены по умолчанию.
+ */
+const std::size_t DEFAULT_HISTORY_DEPTH = 256;
+
+/**
+ * @brief Снимок партии в истории.
+ */
+struct HistoryEntry {
+    Board board = 0;     ///< Упакованное поле.
+    int score = 0;       ///< Счёт.
+    Rng::State rng{};    ///< Состояние генератора.
+};
+
+/**
+ * @brief История одной партии.
+ *
+ * @code
+ * History history(64);
+ * HistoryEntry before = History::capture(game);
+ * if (game.move(Direction::Left)) {
+ *     history.record(before);
+ *     game.generateNumber();
+ * }
+ * history.undo(game);  // поле и счёт до хода влево
+ * history.redo(game);  // снова после хода
+ * @endcode
+ */
+class History {
+public:
+    /**
+     * @brief Выделяет буфер.
+     * @param depth Наибольшее число ходов, которые можно отменить.
+     */
+    explicit History(std::size_t depth = DEFAULT_HISTORY_DEPTH);
+
+    /**
+     * @brief Снимок текущего состояния партии.
+     * @param game Партия.
+     * @return HistoryEntry поле, счёт и генератор партии.
+     */
+    static HistoryEntry capture(const Game& game);
+
+    /**
+     * @brief Запоминает состояние до хода; ходы для повтора отбрасываются.
+     * @param before Снимок партии до хода (capture()).
+     * @return void
+     */
+    void record(const HistoryEntry& before);
+
+    /**
+     * @brief Отменяет последний ход.
+     * @param game Партия, в которую восстанавливается снимок.
+     * @return bool false, если отменять нечего.
+     */
+    bool undo(Game& game) { return cursor_ != 0 && seek(cursor_ - 1, game); }
+
+    /**
+     * @brief Повторяет отменённый ход.
+     * @param game Партия, в которую восстанавливается снимок.
+     * @return bool false, если повторять нечего.
+     */
+    bool redo(Game& game) { return seek(cursor_ + 1, game); }
+
+    /**
+     * @brief Переходит к снимку с заданным номером.
+     * @param position Номер снимка: 0 — самый старый, size() - 1 — самый новый.
+     * @param game Партия, в которую восстанавливается снимок.
+     * @return bool false, если такого снимка нет.
+     *
+     * Текущее состояние партии запоминается, так что к нему можно вернуться.
+     */
+    bool seek(std::size_t position, Game& game);
+
+    /**
+     * @brief Забывает все снимки.
+     * @return void
+     */
+    void clear();
+
+    /** @brief Число снимков, включая текущий после undo() или seek(). */
+    std::size_t size() const { return size_; }
+    /** @brief Номер текущего состояния: столько ходов можно отменить. */
+    std::size_t position() const { return cursor_; }
+    /** @brief Наибольшая глубина отмены. */
+    std::size_t depth() const { return slots_.size() - 1; }
+    /** @brief Есть ход для отмены. */
+    bool canUndo() const { return cursor_ != 0; }
+    /** @brief Есть ход для повтора. */
+    bool canRedo() const { return cursor_ + 1 < size_; }
+
+    /**
+     * @brief Дописывает блок истории.
+     * @param out Буфер, к которому дописывается блок.
+     * @return void
+     */
+    void encode(std::vector<unsigned char>& out) const;
+
+    /**
+     * @brief Читает блок истории.
+     * @param data Байты блока.
+     * @param size Количество байтов.
+     * @return bool true, если блок корректен; иначе история пуста.
+     *
+     * Если в блоке больше снимков, чем помещается в буфер, отбрасываются
+     * самые старые, а затем лишние снимки для повтора.
+     */
+    bool decode(const unsigned char* data, std::size_t size);
+
+private:
+    HistoryEntry& at(std::size_t position) {
+        return slots_[(begin_ + position) % slots_.size()];
+    }
+
+    // Снимки с номерами меньше cursor_ — для отмены, больше — для повтора;
+    // снимок cursor_ (если он есть) совпадает с текущим состоянием.
+    std::vector<HistoryEntry> slots_;
+    std::size_t begin_ = 0;
+    std::size_t size_ = 0;
+    std::size_t cursor_ = 0;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file input.cpp
+ * @brief Реализация посимвольного ввода.
+ *
+ * Содержит определение функций, объявленных в input.h.
+ */
+
+#include "input.h"
+
+#include <cctype>
+#include <cerrno>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "profile.h"
+
+namespace {
+
+const char ESCAPE = '\x1b';
+const char CTRL_C = '\x03';
+const char CTRL_D = '\x04';
+
+// Размер одного чтения; сценарий из канала читается такими кусками.
+const std::size_t READ_CHUNK = 4096;
+
+}
+
+void KeyDecoder::feed(const char* data, std::size_t size, std::string& keys) {
+    for (std::size_t k = 0; k < size; ++k) {
+        char c = data[k];
+        switch (state_) {
+            case State::Escape:
+                if (c == '[' || c == 'O') {
+                    state_ = State::Sequence;
+                    continue;
+                }
+                state_ = State::Text;
+                break;
+            case State::Sequence:
+                // Параметры (ESC [ 1 ; 5 A) пропускаются до завершающего байта.
+                if ((c >= '0' && c <= '9') || c == ';') continue;
+                state_ = State::Text;
+                switch (c) {
+                    case 'A': keys += 'w'; break;
+                    case 'B': keys += 's'; break;
+                    case 'C': keys += 'd'; break;
+                    case 'D': keys += 'a'; break;
+                    default: break;
+                }
+                continue;
+            case State::Text:
+                break;
+        }
+
+        if (c == ESCAPE) {
+            state_ = State::Escape;
+        } else if (c == CTRL_C || c == CTRL_D) {
+            keys += 'q';
+        } else if (std::isgraph(static_cast<unsigned char>(c))) {
+            keys += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+}
+
+KeyReader::KeyReader(int fd) : fd_(fd) {
+    if (!::isatty(fd_) || ::tcgetattr(fd_, &saved_) != 0) return;
+    termios raw = saved_;
+    // Без построчного режима, эха и сигналов: Ctrl+C приходит как клавиша,
+    // и настройки терминала всегда восстанавливаются деструктором.
+    raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    raw_ = ::tcsetattr(fd_, TCSANOW, &raw) == 0;
+}
+
+KeyReader::~KeyReader() {
+    if (raw_) ::tcsetattr(fd_, TCSANOW, &saved_);
+}
+
+bool KeyReader::readBatch(std::string& keys) {
+    char buffer[READ_CHUNK];
+    bool first = true;
+    while (true) {
+        if (!first) {
+            // Дочитываем только то, что уже доступно, не блокируясь.
+            pollfd pending{fd_, POLLIN, 0};
+            if (::poll(&pending, 1, 0) <= 0 || (pending.revents & POLLIN) == 0) return true;
+        }
+        ssize_t got = ::read(fd_, buffer, sizeof(buffer));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return !first;
+        if (first) lastReadCycles_ = cycleCount();
+        first = false;
+        decoder_.feed(buffer, static_cast<std::size_t>(got), keys);
+    }
+}
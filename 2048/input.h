@@ -0,0 +1,107 @@
+/**
+ * @file input.h
+ * @brief Посимвольный ввод с клавиатуры и из сценария.
+ *
+ * Если стандартный ввод — терминал, он переводится в режим без
+ * построчной буферизации и без эха (termios): каждая клавиша доступна
+ * сразу, без Enter, стрелки распознаются по управляющим
+ * последовательностям. Если ввод перенаправлен (канал или файл),
+ * режим терминала не меняется и символы читаются как сценарий ходов.
+ *
+ * Чтение возвращает пачку: все клавиши, уже накопившиеся к моменту
+ * вызова, чтобы игра применила их разом и перерисовала поле один раз.
+ *
+ * Клавиши приводятся к командам move(char): стрелки — 'w', 'a', 's',
+ * 'd', буквы — к нижнему регистру, Ctrl+C и Ctrl+D — 'q'. Пробелы,
+ * переводы строк и прочие управляющие символы пропускаются.
+ */
+
+#ifndef GAME_2048_INPUT_H
+#define GAME_2048_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <termios.h>
+
+/**
+ * @brief Разбор потока байтов на клавиши.
+ *
+ * Состояние сохраняется между вызовами feed(), поэтому управляющая
+ * последовательность может прийти по частям.
+ */
+class KeyDecoder {
+public:
+    /**
+     * @brief Разбирает байты и дописывает распознанные клавиши.
+     * @param data Байты ввода.
+     * @param size Количество байтов.
+     * @param keys Строка, в которую дописываются клавиши.
+     * @return void
+     *
+     * @code
+     * KeyDecoder decoder;
+     * std::string keys;
+     * decoder.feed("W\x1b[D", 4, keys);  // keys == "wa"
+     * @endcode
+     */
+    void feed(const char* data, std::size_t size, std::string& keys);
+
+private:
+    enum class State : std::uint8_t { Text, Escape, Sequence };
+
+    State state_ = State::Text;
+};
+
+/**
+ * @brief Читатель клавиш со стандартного (или заданного) ввода.
+ *
+ * Пока объект существует, терминал находится в режиме посимвольного
+ * ввода; деструктор восстанавливает исходные настройки.
+ */
+class KeyReader {
+public:
+    /**
+     * @brief Открывает ввод и, если это терминал, включает посимвольный режим.
+     * @param fd Файловый дескриптор ввода.
+     */
+    explicit KeyReader(int fd = 0);
+
+    /** @brief Восстанавливает настройки терминала. */
+    ~KeyReader();
+
+    KeyReader(const KeyReader&) = delete;
+    KeyReader& operator=(const KeyReader&) = delete;
+
+    /**
+     * @brief Ждёт хотя бы одну клавишу и забирает все уже доступные.
+     * @param keys Строка, в которую дописываются клавиши.
+     * @return bool false, если ввод закончился или произошла ошибка.
+     *
+     * Может вернуть true, не дописав ни одной клавиши (например, если
+     * пришли только пробелы); тогда вызов повторяют.
+     */
+    bool readBatch(std::string& keys);
+
+    /**
+     * @brief Включён ли посимвольный режим терминала.
+     * @return bool true для терминала, false для сценария.
+     */
+    bool interactive() const { return raw_; }
+
+    /**
+     * @brief Время поступления последней пачки.
+     * @return std::uint64_t значение cycleCount() сразу после чтения.
+     */
+    std::uint64_t lastReadCycles() const { return lastReadCycles_; }
+
+private:
+    int fd_;
+    bool raw_ = false;
+    termios saved_{};
+    KeyDecoder decoder_;
+    std::uint64_t lastReadCycles_ = 0;
+};
+
+#endif
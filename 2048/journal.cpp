@@ -0,0 +1,152 @@
+/**
+ * @file journal.cpp
+ * @brief Реализация журнала ходов.
+ *
+ * Содержит определение функций, объявленных в journal.h.
+ */
+
+#include "journal.h"
+
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace {
+
+const unsigned char SNAPSHOT_TAG = 'S';
+const unsigned char MOVE_FLAG = 0x80;
+
+unsigned char encodeMove(Direction dir, int cell, int exponent) {
+    return static_cast<unsigned char>(MOVE_FLAG | (cell << 3) | ((exponent - 1) << 2) |
+                                      static_cast<int>(dir));
+}
+
+JournalMove decodeMove(unsigned char byte) {
+    JournalMove move;
+    move.dir = static_cast<Direction>(byte & 0x3);
+    move.spawnExponent = ((byte >> 2) & 0x1) + 1;
+    move.spawnCell = (byte >> 3) & 0xF;
+    return move;
+}
+
+}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open(const std::string& path, const Game& game) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) return false;
+    writeSnapshot(game);
+    return flush();
+}
+
+bool Journal::resume(const std::string& path, std::uint64_t validBytes, const Game& game) {
+    close();
+    std::error_code ec;
+    std::filesystem::resize_file(path, validBytes, ec);
+    if (ec) return false;
+    file_ = std::fopen(path.c_str(), "ab");
+    if (file_ == nullptr) return false;
+    writeSnapshot(game);
+    return flush();
+}
+
+void Journal::recordMove(Direction dir, Board moved, const Game& game) {
+    if (file_ == nullptr) return;
+
+    Board spawned = game.board() ^ moved;
+    int shift = std::countr_zero(spawned) & ~3;
+    auto exponent = static_cast<int>((spawned >> shift) & 0xF);
+    buffer_.push_back(encodeMove(dir, shift / 4, exponent));
+
+    if (++movesSinceSnapshot_ >= options_.snapshotInterval)
+        writeSnapshot(game);
+
+    if (buffer_.size() >= options_.batchBytes ||
+        std::chrono::steady_clock::now() - lastFlush_ >= options_.flushInterval)
+        flush();
+}
+
+bool Journal::flush() {
+    lastFlush_ = std::chrono::steady_clock::now();
+    if (file_ == nullptr) return false;
+    bool ok = buffer_.empty() || std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+    ok = std::fflush(file_) == 0 && ok;
+    buffer_.clear();
+    return ok;
+}
+
+void Journal::close() {
+    if (file_ == nullptr) return;
+    flush();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void Journal::writeSnapshot(const Game& game) {
+    auto bytes = encodeSaveRecord(game.snapshot());
+    buffer_.push_back(SNAPSHOT_TAG);
+    buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+    movesSinceSnapshot_ = 0;
+}
+
+bool Journal::replay(const std::string& path, Game& game, std::uint64_t* validBytes,
+                     std::vector<JournalMove>* moves) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)),
+                                    std::istreambuf_iterator<char>());
+
+    // Первый проход: границы записей и последний целый снимок. Если нужна
+    // вся история ходов, воспроизведение начинается с первого снимка.
+    std::size_t end = 0, start = data.size();
+    while (end < data.size()) {
+        if (data[end] == SNAPSHOT_TAG) {
+            SaveRecord record;
+            if (data.size() - end < 1 + SAVE_RECORD_SIZE ||
+                !decodeSaveRecord(&data[end + 1], SAVE_RECORD_SIZE, record))
+                break;
+            if (moves == nullptr || start == data.size()) start = end;
+            end += 1 + SAVE_RECORD_SIZE;
+        } else if ((data[end] & MOVE_FLAG) != 0 && start != data.size()) {
+            ++end;
+        } else {
+            break;
+        }
+    }
+    if (start == data.size()) return false;
+
+    std::size_t pos = start;
+    while (pos < end) {
+        if (data[pos] == SNAPSHOT_TAG) {
+            SaveRecord record;
+            decodeSaveRecord(&data[pos + 1], SAVE_RECORD_SIZE, record);
+            game.restore(record);
+            pos += 1 + SAVE_RECORD_SIZE;
+            continue;
+        }
+
+        // Ход воспроизводится по правилам игры; появившееся число
+        // должно совпасть с записанным, иначе хвост журнала повреждён.
+        JournalMove move = decodeMove(data[pos]);
+        Game next = game;
+        if (!next.move(move.dir)) break;
+        Board moved = next.board();
+        next.generateNumber();
+        if ((next.board() ^ moved) !=
+            static_cast<Board>(move.spawnExponent) << (4 * move.spawnCell))
+            break;
+        if (next.score() > next.bestScore()) next.setBestScore(next.score());
+        game = next;
+        if (moves != nullptr) moves->push_back(move);
+        ++pos;
+    }
+
+    if (validBytes != nullptr) *validBytes = pos;
+    return true;
+}
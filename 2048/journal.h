@@ -0,0 +1,145 @@
+/**
+ * @file journal.h
+ * @brief Журнал ходов: запись партии дописыванием вместо полного сохранения.
+ *
+ * Файл журнала — последовательность записей двух видов:
+ * - снимок: байт 'S' и запись сохранения (см. savefile.h);
+ * - ход: один байт 1ccccvdd, где dd — направление (Direction),
+ *   v — появившееся число (0 — 2, 1 — 4), cccc — номер ячейки.
+ *
+ * Записи накапливаются в буфере и дописываются в файл пачками:
+ * когда буфер заполнен или при записи хода истёк интервал сброса.
+ * Таймера нет, поэтому перед простоем (например, ожиданием ввода)
+ * владелец журнала вызывает flush(). Каждые snapshotInterval ходов
+ * добавляется новый снимок.
+ *
+ * Восстановление начинается с первого снимка и воспроизводит ходы
+ * через Game::move() и Game::generateNumber(); появившееся число
+ * сверяется с записанным. Оборванный или повреждённый хвост
+ * отбрасывается, и партия восстанавливается до последней верной записи.
+ */
+
+#ifndef GAME_2048_JOURNAL_H
+#define GAME_2048_JOURNAL_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "game.h"
+
+/**
+ * @brief Один ход из журнала.
+ */
+struct JournalMove {
+    Direction dir = Direction::Up;  ///< Направление хода.
+    int spawnCell = 0;              ///< Номер ячейки (4 * строка + столбец), где появилось число.
+    int spawnExponent = 1;          ///< Показатель появившегося числа (1 — 2, 2 — 4).
+};
+
+/**
+ * @brief Параметры записи журнала.
+ */
+struct JournalOptions {
+    std::size_t batchBytes = 4096;                   ///< Размер буфера до принудительного сброса.
+    std::chrono::milliseconds flushInterval{1000};   ///< Наибольшее время между сбросами.
+    int snapshotInterval = 256;                      ///< Ходов между снимками.
+};
+
+/**
+ * @brief Журнал одной партии.
+ *
+ * @code
+ * Journal journal;
+ * journal.open("savegame.journal", game);
+ * if (game.move(Direction::Left)) {
+ *     Board moved = game.board();
+ *     game.generateNumber();
+ *     journal.recordMove(Direction::Left, moved, game);
+ * }
+ * @endcode
+ */
+class Journal {
+public:
+    Journal() = default;
+
+    /**
+     * @brief Создаёт журнал с заданными параметрами.
+     * @param options Параметры буферизации и снимков.
+     */
+    explicit Journal(const JournalOptions& options) : options_(options) {}
+
+    /** @brief Сбрасывает буфер и закрывает файл. */
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /**
+     * @brief Начинает новый журнал: очищает файл и пишет снимок партии.
+     * @param path Файл журнала.
+     * @param game Начальное состояние партии.
+     * @return bool true, если файл открыт.
+     */
+    bool open(const std::string& path, const Game& game);
+
+    /**
+     * @brief Продолжает журнал после replay(): отрезает повреждённый хвост и пишет снимок.
+     * @param path Файл журнала.
+     * @param validBytes Длина верной части файла, возвращённая replay().
+     * @param game Восстановленное состояние партии.
+     * @return bool true, если файл открыт.
+     */
+    bool resume(const std::string& path, std::uint64_t validBytes, const Game& game);
+
+    /**
+     * @brief Записывает ход и появившееся после него число.
+     * @param dir Направление хода.
+     * @param moved Поле после хода, до появления числа.
+     * @param game Партия после появления числа.
+     * @return void
+     */
+    void recordMove(Direction dir, Board moved, const Game& game);
+
+    /**
+     * @brief Дописывает буфер в файл.
+     * @return bool true, если запись успешна.
+     */
+    bool flush();
+
+    /**
+     * @brief Сбрасывает буфер и закрывает файл.
+     * @return void
+     */
+    void close();
+
+    /**
+     * @brief Открыт ли журнал.
+     * @return bool true, если файл открыт.
+     */
+    bool isOpen() const { return file_ != nullptr; }
+
+    /**
+     * @brief Восстанавливает партию из журнала.
+     * @param path Файл журнала.
+     * @param game Партия, в которую записывается результат.
+     * @param validBytes Длина верной части файла (может быть nullptr).
+     * @param moves Если не nullptr, сюда дописываются все воспроизведённые ходы.
+     * @return bool true, если найден хотя бы один снимок.
+     */
+    static bool replay(const std::string& path, Game& game, std::uint64_t* validBytes = nullptr,
+                       std::vector<JournalMove>* moves = nullptr);
+
+private:
+    void writeSnapshot(const Game& game);
+
+    JournalOptions options_;
+    std::FILE* file_ = nullptr;
+    std::vector<unsigned char> buffer_;
+    std::chrono::steady_clock::time_point lastFlush_;
+    int movesSinceSnapshot_ = 0;
+};
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * @file ntuple.cpp
+ * @brief Реализация сети n-кортежей и её файла весов.
+ *
+ * Содержит определение функций, объявленных в ntuple.h.
+ */
+
+#include "ntuple.h"
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "savefile.h"
+
+namespace {
+
+const char NTUPLE_MAGIC[8] = {'2', '0', '4', '8', 'N', 'T', 'U', 'P'};
+const std::size_t HEADER_SIZE = 32;
+const std::size_t PATTERN_RECORD_SIZE = 16;
+const std::size_t WEIGHTS_ALIGNMENT = 64;
+
+std::size_t weightsOffset(std::size_t patterns) {
+    std::size_t end = HEADER_SIZE + patterns * PATTERN_RECORD_SIZE;
+    return (end + WEIGHTS_ALIGNMENT - 1) / WEIGHTS_ALIGNMENT * WEIGHTS_ALIGNMENT;
+}
+
+bool validPattern(const NTuplePattern& pattern) {
+    if (pattern.empty() || pattern.size() > static_cast<std::size_t>(MAX_TUPLE_SIZE)) return false;
+    for (int cell : pattern)
+        if (cell < 0 || cell >= BOARD_SIZE * BOARD_SIZE) return false;
+    return true;
+}
+
+std::uint64_t weightCount(const std::vector<NTuplePattern>& patterns) {
+    std::uint64_t count = 0;
+    for (const NTuplePattern& pattern : patterns) count += std::uint64_t{1} << (4 * pattern.size());
+    return count;
+}
+
+}
+
+std::vector<NTuplePattern> ntuplePatterns(std::string_view name) {
+    if (name == "small")
+        return {{0, 1, 2, 3}, {4, 5, 6, 7}, {0, 1, 4, 5}, {1, 2, 5, 6}, {5, 6, 9, 10}};
+    if (name == "large")
+        return {{0, 1, 2, 3, 4, 5}, {4, 5, 6, 7, 8, 9}, {0, 1, 2, 4, 5, 6}, {4, 5, 6, 8, 9, 10}};
+    return {};
+}
+
+NTupleNetwork::~NTupleNetwork() {
+    close();
+}
+
+bool NTupleNetwork::create(const std::vector<NTuplePattern>& patterns) {
+    close();
+    if (!NATIVE_LITTLE_ENDIAN || patterns.empty() || patterns.size() > 0xFFFF) return false;
+    for (const NTuplePattern& pattern : patterns)
+        if (!validPattern(pattern)) return false;
+
+    std::uint64_t count = weightCount(patterns);
+    std::size_t size = weightsOffset(patterns.size()) + count * sizeof(float);
+    // Анонимное отображение: нулевые страницы выделяются по мере обращения.
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) return false;
+
+    auto* data = static_cast<unsigned char*>(mapping);
+    std::memcpy(data, NTUPLE_MAGIC, sizeof(NTUPLE_MAGIC));
+    writeField<std::uint16_t>(data + 8, NTUPLE_VERSION);
+    writeField<std::uint16_t>(data + 10, BOARD_ENCODING);
+    writeField<std::uint16_t>(data + 12, static_cast<std::uint16_t>(patterns.size()));
+    writeField<std::uint64_t>(data + 16, count);
+    unsigned char* records = data + HEADER_SIZE;
+    for (std::size_t p = 0; p < patterns.size(); ++p) {
+        unsigned char* record = records + p * PATTERN_RECORD_SIZE;
+        record[0] = static_cast<unsigned char>(patterns[p].size());
+        for (std::size_t k = 0; k < patterns[p].size(); ++k)
+            record[1 + k] = static_cast<unsigned char>(patterns[p][k]);
+    }
+    writeField<std::uint32_t>(data + 24, fnv1a(data, 24));
+    writeField<std::uint32_t>(data + 28, fnv1a(records, patterns.size() * PATTERN_RECORD_SIZE));
+
+    if (!attach(data, size)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+    return true;
+}
+
+bool NTupleNetwork::open(const std::string& path, bool writable) {
+    close();
+    if (!NATIVE_LITTLE_ENDIAN) return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    auto size = static_cast<std::size_t>(info.st_size);
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapping = ::mmap(nullptr, size, protection, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    if (!attach(static_cast<unsigned char*>(mapping), size)) {
+        ::munmap(mapping, size);
+        return false;
+    }
+    // Признаки обращаются к весам вразброс.
+    ::madvise(mapping, size, MADV_RANDOM);
+    return true;
+}
+
+bool NTupleNetwork::attach(unsigned char* data, std::size_t size) {
+    if (std::memcmp(data, NTUPLE_MAGIC, sizeof(NTUPLE_MAGIC)) != 0 ||
+        readField<std::uint16_t>(data + 8) != NTUPLE_VERSION ||
+        readField<std::uint16_t>(data + 10) != BOARD_ENCODING ||
+        readField<std::uint32_t>(data + 24) != fnv1a(data, 24))
+        return false;
+
+    std::size_t count = readField<std::uint16_t>(data + 12);
+    const unsigned char* records = data + HEADER_SIZE;
+    if (count == 0 || weightsOffset(count) > size ||
+        readField<std::uint32_t>(data + 28) != fnv1a(records, count * PATTERN_RECORD_SIZE))
+        return false;
+
+    std::vector<NTuplePattern> patterns(count);
+    for (std::size_t p = 0; p < count; ++p) {
+        const unsigned char* record = records + p * PATTERN_RECORD_SIZE;
+        patterns[p].assign(record + 1, record + 1 + record[0]);
+        if (!validPattern(patterns[p])) return false;
+    }
+    std::uint64_t weights = weightCount(patterns);
+    if (readField<std::uint64_t>(data + 16) != weights ||
+        size != weightsOffset(count) + weights * sizeof(float))
+        return false;
+
+    features_.clear();
+    std::size_t offset = 0;
+    for (const NTuplePattern& pattern : patterns) {
+        // Веса общие для всех симметрий шаблона, так что таблица весов
+        // в восемь раз меньше, чем при отдельных весах для каждой.
+        for (int symmetry = 0; symmetry < SYMMETRY_COUNT; ++symmetry) {
+            Feature feature;
+            feature.offset = offset;
+            feature.size = static_cast<int>(pattern.size());
+            for (std::size_t k = 0; k < pattern.size(); ++k)
+                feature.shifts[k] =
+                    static_cast<std::uint8_t>(4 * symmetryCell(pattern[k], symmetry));
+            features_.push_back(feature);
+        }
+        offset += std::size_t{1} << (4 * pattern.size());
+    }
+
+    data_ = data;
+    size_ = size;
+    weights_ = reinterpret_cast<float*>(data + weightsOffset(count));
+    patterns_ = std::move(patterns);
+    return true;
+}
+
+bool NTupleNetwork::save(const std::string& path) const {
+    return data_ != nullptr && writeFileAtomic(path, data_, size_);
+}
+
+void NTupleNetwork::close() {
+    if (data_ != nullptr) ::munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    weights_ = nullptr;
+    patterns_.clear();
+    features_.clear();
+}
+
+std::size_t NTupleNetwork::index(const Feature& feature, Board b) const {
+    std::size_t result = 0;
+    for (int k = 0; k < feature.size; ++k)
+        result |= ((b >> feature.shifts[k]) & 0xF) << (4 * k);
+    return feature.offset + result;
+}
+
+float NTupleNetwork::evaluate(Board b) const {
+    float value = 0.0f;
+    for (const Feature& feature : features_)
+        value += std::atomic_ref<float>(weights_[index(feature, b)]).load(std::memory_order_relaxed);
+    return value;
+}
+
+void NTupleNetwork::update(Board b, float delta) {
+    for (const Feature& feature : features_) {
+        std::atomic_ref<float> weight(weights_[index(feature, b)]);
+        weight.store(weight.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+}
+
+std::optional<Direction> NTupleNetwork::bestMove(Board b) const {
+    std::optional<Direction> best;
+    float bestValue = 0.0f;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int gained = 0;
+        Board next = moveBoard(b, dir, gained);
+        if (next == b) continue;
+        float value = static_cast<float>(gained) + evaluate(next);
+        if (!best || value > bestValue) {
+            best = dir;
+            bestValue = value;
+        }
+    }
+    return best;
+}
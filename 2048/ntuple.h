@@ -0,0 +1,173 @@
+/**
+ * @file ntuple.h
+ * @brief Сеть n-кортежей: обучаемая оценка поля по таблицам весов.
+ *
+ * Шаблон — упорядоченный набор ячеек поля. Показатели плиток в этих
+ * ячейках образуют индекс в таблицу весов шаблона (16^n записей).
+ * Каждый шаблон применяется во всех восьми симметриях поля с общей
+ * таблицей, а оценка поля — сумма весов по всем шаблонам и симметриям.
+ *
+ * Файл весов плоский и отображается в память как есть:
+ * - заголовок из 32 байт: "2048NTUP", версия u16, BOARD_ENCODING u16,
+ *   число шаблонов u16, резерв u16, число весов u64, FNV-1a байтов
+ *   0..23 u32, FNV-1a таблицы шаблонов u32;
+ * - таблица шаблонов по 16 байт: длина u8 и номера ячеек u8 (4 * строка
+ *   + столбец, как сдвиг ячейки / 4), остаток заполнен нулями;
+ * - выравнивание нулями до кратного 64 смещения;
+ * - веса float подряд, шаблон за шаблоном, little-endian.
+ *
+ * В памяти сеть хранится в том же виде, поэтому контрольная точка —
+ * одна запись буфера через writeFileAtomic(), а загрузка — mmap() и
+ * проверка заголовка, без разбора и копирования весов.
+ */
+
+#ifndef GAME_2048_NTUPLE_H
+#define GAME_2048_NTUPLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * @brief Версия формата файла весов.
+ */
+const std::uint16_t NTUPLE_VERSION = 1;
+
+/**
+ * @brief Наибольшая длина шаблона: 16^7 весов — уже 1 ГиБ.
+ */
+const int MAX_TUPLE_SIZE = 7;
+
+/**
+ * @brief Шаблон: номера ячеек поля (4 * строка + столбец).
+ */
+using NTuplePattern = std::vector<int>;
+
+/**
+ * @brief Готовые наборы шаблонов.
+ * @param name "small" — строки и квадраты 2x2 по 4 ячейки (1.3 МБ весов);
+ *             "large" — четыре шаблона по 6 ячеек (256 МиБ весов).
+ * @return std::vector<NTuplePattern> шаблоны или пустой вектор для неизвестного имени.
+ */
+std::vector<NTuplePattern> ntuplePatterns(std::string_view name);
+
+/**
+ * @brief Сеть n-кортежей с весами в памяти или в отображённом файле.
+ *
+ * evaluate() и update() обращаются к весам через std::atomic_ref без
+ * упорядочивания, поэтому несколько потоков обучения могут обновлять
+ * общие веса без блокировок (Hogwild): одновременные обновления одного
+ * веса иногда теряются, что обучению не мешает.
+ *
+ * @code
+ * NTupleNetwork network;
+ * if (network.open("weights.ntuple"))
+ *     if (auto dir = network.bestMove(game.board())) game.move(*dir);
+ * @endcode
+ */
+class NTupleNetwork {
+public:
+    NTupleNetwork() = default;
+
+    /** @brief Освобождает веса. */
+    ~NTupleNetwork();
+
+    NTupleNetwork(const NTupleNetwork&) = delete;
+    NTupleNetwork& operator=(const NTupleNetwork&) = delete;
+
+    /**
+     * @brief Создаёт сеть с нулевыми весами.
+     * @param patterns Шаблоны длиной от 1 до MAX_TUPLE_SIZE с ячейками 0..15.
+     * @return bool false, если шаблоны неверны или не хватило памяти.
+     */
+    bool create(const std::vector<NTuplePattern>& patterns);
+
+    /**
+     * @brief Отображает файл весов в память.
+     * @param path Файл весов.
+     * @param writable true — веса можно дообучать (копия при записи, файл не меняется).
+     * @return bool false, если файла нет, он повреждён или другой версии.
+     */
+    bool open(const std::string& path, bool writable = false);
+
+    /**
+     * @brief Записывает веса атомарно (см. writeFileAtomic()).
+     * @param path Файл весов.
+     * @return bool true, если файл записан.
+     *
+     * Во время обучения это снимок весов, которые другие потоки
+     * продолжают менять.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Освобождает веса.
+     * @return void
+     */
+    void close();
+
+    /**
+     * @brief Загружена ли сеть.
+     * @return bool true после успешных create() или open().
+     */
+    bool isOpen() const { return data_ != nullptr; }
+
+    /**
+     * @brief Шаблоны сети.
+     * @return const std::vector<NTuplePattern>& шаблоны.
+     */
+    const std::vector<NTuplePattern>& patterns() const { return patterns_; }
+
+    /**
+     * @brief Число слагаемых оценки: шаблоны, умноженные на 8 симметрий.
+     * @return std::size_t число признаков.
+     */
+    std::size_t features() const { return features_.size(); }
+
+    /**
+     * @brief Оценка поля.
+     * @param b Упакованное поле.
+     * @return float сумма весов признаков.
+     */
+    float evaluate(Board b) const;
+
+    /**
+     * @brief Прибавляет delta к весу каждого признака поля.
+     * @param b Упакованное поле.
+     * @param delta Изменение одного веса.
+     * @return void
+     *
+     * Только для сетей из create() или open(path, true).
+     */
+    void update(Board b, float delta);
+
+    /**
+     * @brief Ход с наибольшей суммой очков хода и оценки поля после него.
+     * @param b Упакованное поле.
+     * @return std::optional<Direction> ход или std::nullopt, если ходов нет.
+     */
+    std::optional<Direction> bestMove(Board b) const;
+
+private:
+    struct Feature {
+        std::size_t offset = 0;
+        int size = 0;
+        std::uint8_t shifts[MAX_TUPLE_SIZE] = {};
+    };
+
+    bool attach(unsigned char* data, std::size_t size);
+    std::size_t index(const Feature& feature, Board b) const;
+
+    unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+    float* weights_ = nullptr;
+    std::vector<NTuplePattern> patterns_;
+    std::vector<Feature> features_;
+};
+
+#endif
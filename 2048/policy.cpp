@@ -0,0 +1,81 @@
+/**
+ * @file policy.cpp
+ * @brief Реализация стратегий выбора хода.
+ *
+ * Содержит определение функций, объявленных в policy.h.
+ */
+
+#include "policy.h"
+#include "simulator.h"
+
+void RandomPolicy::newGame(std::uint64_t seed) {
+    rng_.seed(seed);
+}
+
+Direction RandomPolicy::chooseMove(const Game& game) {
+    Direction legal[4];
+    int count = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int unused = 0;
+        if (moveBoard(game.board(), dir, unused) != game.board())
+            legal[count++] = dir;
+    }
+    if (count == 0) return Direction::Up;
+    return legal[rng_.below(static_cast<std::uint32_t>(count))];
+}
+
+Direction GreedyPolicy::chooseMove(const Game& game) {
+    Direction best = Direction::Up;
+    int bestGain = -1;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int gained = 0;
+        if (moveBoard(game.board(), dir, gained) == game.board()) continue;
+        if (gained > bestGain) {
+            bestGain = gained;
+            best = dir;
+        }
+    }
+    return best;
+}
+
+Direction ExpectimaxPolicy::chooseMove(const Game& game) {
+    return search_.bestMove(game.board(), budget_).value_or(Direction::Up);
+}
+
+void MonteCarloPolicy::newGame(std::uint64_t seed) {
+    seed_ = seed;
+    moveIndex_ = 0;
+}
+
+Direction MonteCarloPolicy::chooseMove(const Game& game) {
+    return search_.bestMove(game.board(), playouts_, gameSeed(seed_, moveIndex_++))
+        .value_or(Direction::Up);
+}
+
+Direction NTuplePolicy::chooseMove(const Game& game) {
+    return network_.bestMove(game.board()).value_or(Direction::Up);
+}
+
+PolicyFactory policyByName(const std::string& name, const SearchBudget& budget,
+                           const OpeningBook* book, const BoardEvaluator* evaluator,
+                           const NTupleNetwork* network) {
+    if (name == "random")
+        return [] { return std::make_unique<RandomPolicy>(); };
+    if (name == "greedy")
+        return [] { return std::make_unique<GreedyPolicy>(); };
+    if (name == "expectimax")
+        return [budget, book, evaluator] {
+            return std::make_unique<ExpectimaxPolicy>(budget, book, evaluator);
+        };
+    if (name == "montecarlo") {
+        int playouts = budget.playouts > 0 ? budget.playouts : 100;
+        return [playouts] { return std::make_unique<MonteCarloPolicy>(playouts); };
+    }
+    if (name == "ntuple" && network != nullptr)
+        return [network] { return std::make_unique<NTuplePolicy>(*network); };
+    return {};
+}
+
+std::vector<std::string> policyNames() {
+    return {"random", "greedy", "expectimax", "montecarlo", "ntuple"};
+}
@@ -0,0 +1,170 @@
+/**
+ * @file policy.h
+ * @brief Стратегии выбора хода для автоматической игры.
+ *
+ * Стратегия получает партию и возвращает направление хода.
+ * Экземпляр стратегии используется одним потоком, поэтому может
+ * хранить собственное изменяемое состояние (генератор, кэши).
+ */
+
+#ifndef GAME_2048_POLICY_H
+#define GAME_2048_POLICY_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ai.h"
+#include "board.h"
+#include "game.h"
+#include "ntuple.h"
+#include "rng.h"
+#include "rollout.h"
+
+/**
+ * @brief Интерфейс стратегии выбора хода.
+ */
+class Policy {
+public:
+    virtual ~Policy() = default;
+
+    /**
+     * @brief Вызывается перед началом каждой партии.
+     * @param seed Зерно партии; стратегия может использовать его для своего генератора.
+     * @return void
+     */
+    virtual void newGame(std::uint64_t seed) { (void)seed; }
+
+    /**
+     * @brief Выбирает ход.
+     * @param game Текущая партия; вызывается, только если game.canMove().
+     * @return Direction направление, которое изменяет поле.
+     */
+    virtual Direction chooseMove(const Game& game) = 0;
+};
+
+/**
+ * @brief Случайный ход среди тех, что изменяют поле.
+ */
+class RandomPolicy : public Policy {
+public:
+    void newGame(std::uint64_t seed) override;
+    Direction chooseMove(const Game& game) override;
+
+private:
+    Rng rng_;
+};
+
+/**
+ * @brief Ход, дающий наибольший прирост счёта (при равенстве — первый в порядке 'wasd').
+ */
+class GreedyPolicy : public Policy {
+public:
+    Direction chooseMove(const Game& game) override;
+};
+
+/**
+ * @brief Лучший ход по поиску expectimax (см. ai.h).
+ */
+class ExpectimaxPolicy : public Policy {
+public:
+    /**
+     * @brief Создаёт стратегию с заданными ограничениями поиска.
+     * @param budget Глубина или время на ход.
+     * @param book Книга ходов или nullptr (см. ExpectimaxSearch::setBook()).
+     * @param evaluator Оценка листьев или nullptr (см. ExpectimaxSearch::setEvaluator()).
+     */
+    explicit ExpectimaxPolicy(const SearchBudget& budget, const OpeningBook* book = nullptr,
+                              const BoardEvaluator* evaluator = nullptr)
+        : budget_(budget) {
+        search_.setBook(book);
+        search_.setEvaluator(evaluator);
+    }
+
+    /**
+     * @brief Поиск стратегии, например для чтения статистики последнего хода.
+     * @return const ExpectimaxSearch& поиск.
+     */
+    const ExpectimaxSearch& search() const { return search_; }
+
+    Direction chooseMove(const Game& game) override;
+
+private:
+    SearchBudget budget_;
+    ExpectimaxSearch search_;
+};
+
+/**
+ * @brief Ход с наибольшим средним счётом случайных партий (см. rollout.h).
+ *
+ * Поиск идёт в одном потоке: в симуляторе параллельны сами партии.
+ */
+class MonteCarloPolicy : public Policy {
+public:
+    /**
+     * @brief Создаёт стратегию.
+     * @param playouts Случайных партий на каждое направление.
+     */
+    explicit MonteCarloPolicy(int playouts) : playouts_(playouts), search_(1) {}
+
+    void newGame(std::uint64_t seed) override;
+    Direction chooseMove(const Game& game) override;
+
+private:
+    int playouts_;
+    std::uint64_t seed_ = 0;
+    std::uint64_t moveIndex_ = 0;
+    MonteCarloSearch search_;
+};
+
+/**
+ * @brief Ход по обученной сети n-кортежей (см. ntuple.h): без поиска,
+ *        по очкам хода и оценке поля после него.
+ */
+class NTuplePolicy : public Policy {
+public:
+    /**
+     * @brief Создаёт стратегию.
+     * @param network Сеть; должна жить дольше стратегии.
+     */
+    explicit NTuplePolicy(const NTupleNetwork& network) : network_(network) {}
+
+    Direction chooseMove(const Game& game) override;
+
+private:
+    const NTupleNetwork& network_;
+};
+
+/**
+ * @brief Фабрика стратегий: создаёт новый экземпляр для каждого потока.
+ */
+using PolicyFactory = std::function<std::unique_ptr<Policy>()>;
+
+/**
+ * @brief Возвращает фабрику стратегии по имени.
+ * @param name Имя стратегии ("random", "greedy", "expectimax", "montecarlo", "ntuple").
+ * @param budget Ограничения поиска для стратегий с поиском.
+ * @param book Книга ходов для "expectimax" или nullptr; должна жить дольше стратегий.
+ * @param evaluator Оценка листьев для "expectimax" или nullptr; должна жить дольше стратегий.
+ * @param network Сеть для "ntuple"; без неё "ntuple" не создаётся.
+ * @return PolicyFactory фабрика или пустая функция для неизвестного имени.
+ *
+ * @code
+ * PolicyFactory factory = policyByName("greedy");
+ * if (!factory) return 1;
+ * @endcode
+ */
+PolicyFactory policyByName(const std::string& name, const SearchBudget& budget = {},
+                           const OpeningBook* book = nullptr,
+                           const BoardEvaluator* evaluator = nullptr,
+                           const NTupleNetwork* network = nullptr);
+
+/**
+ * @brief Имена всех известных стратегий.
+ * @return std::vector<std::string> список имён.
+ */
+std::vector<std::string> policyNames();
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file profile.cpp
+ * @brief Реализация счётчиков горячих функций.
+ *
+ * Содержит определение функций, объявленных в profile.h.
+ */
+
+#include "profile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Счётчики одного потока. Пишет только владелец (load + store без
+// read-modify-write), читатели складывают их под registryMutex.
+struct ThreadCounters {
+    std::array<std::atomic<std::uint64_t>, PROFILE_POINT_COUNT> calls{};
+    std::array<std::atomic<std::uint64_t>, PROFILE_POINT_COUNT> cycles{};
+
+    ThreadCounters();
+    ~ThreadCounters();
+};
+
+std::mutex registryMutex;
+std::vector<ThreadCounters*> liveThreads;
+// Счётчики завершившихся потоков.
+ProfileSnapshot retired{};
+
+const std::uint64_t startTicks = cycleCount();
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+ThreadCounters::ThreadCounters() {
+    std::lock_guard lock(registryMutex);
+    liveThreads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    std::lock_guard lock(registryMutex);
+    for (std::size_t p = 0; p < PROFILE_POINT_COUNT; ++p) {
+        retired[p].calls += calls[p].load(std::memory_order_relaxed);
+        retired[p].cycles += cycles[p].load(std::memory_order_relaxed);
+    }
+    liveThreads.erase(std::find(liveThreads.begin(), liveThreads.end(), this));
+}
+
+void bump(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+}
+
+void profileRecord(ProfilePoint point, std::uint64_t cycles) {
+    thread_local ThreadCounters counters;
+    auto p = static_cast<std::size_t>(point);
+    bump(counters.calls[p], 1);
+    bump(counters.cycles[p], cycles);
+}
+
+ProfileSnapshot profileSnapshot() {
+    std::lock_guard lock(registryMutex);
+    ProfileSnapshot total = retired;
+    for (const ThreadCounters* counters : liveThreads)
+        for (std::size_t p = 0; p < PROFILE_POINT_COUNT; ++p) {
+            total[p].calls += counters->calls[p].load(std::memory_order_relaxed);
+            total[p].cycles += counters->cycles[p].load(std::memory_order_relaxed);
+        }
+    return total;
+}
+
+void profileReset() {
+    std::lock_guard lock(registryMutex);
+    retired = ProfileSnapshot{};
+    for (ThreadCounters* counters : liveThreads)
+        for (std::size_t p = 0; p < PROFILE_POINT_COUNT; ++p) {
+            counters->calls[p].store(0, std::memory_order_relaxed);
+            counters->cycles[p].store(0, std::memory_order_relaxed);
+        }
+}
+
+const char* profilePointName(ProfilePoint point) {
+    static const char* const names[PROFILE_POINT_COUNT] = {
+        "move", "moveUp", "moveLeft", "moveDown", "moveRight",
+        "generateNumber", "canMove", "saveGame", "loadGame", "printBoard",
+        "inputToFrame"};
+    auto p = static_cast<std::size_t>(point);
+    return p < PROFILE_POINT_COUNT ? names[p] : "?";
+}
+
+double profileTicksPerNs() {
+    auto elapsed = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - startTime).count();
+    if (elapsed <= 0.0) return 1.0;
+    double ratio = static_cast<double>(cycleCount() - startTicks) / elapsed;
+    return ratio > 0.0 ? ratio : 1.0;
+}
+
+void printProfile(std::ostream& out) {
+    ProfileSnapshot snapshot = profileSnapshot();
+    double ticksPerNs = profileTicksPerNs();
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(16) << "point" << std::right << std::setw(12) << "calls"
+        << std::setw(14) << "cycles/call" << std::setw(12) << "ns/call" << std::setw(12)
+        << "total ms" << '\n';
+    for (std::size_t p = 0; p < PROFILE_POINT_COUNT; ++p) {
+        const ProfileCounter& c = snapshot[p];
+        if (c.calls == 0) continue;
+        double perCall = static_cast<double>(c.cycles) / static_cast<double>(c.calls);
+        out << std::left << std::setw(16) << profilePointName(static_cast<ProfilePoint>(p))
+            << std::right << std::setw(12) << c.calls << std::fixed << std::setprecision(1)
+            << std::setw(14) << perCall << std::setw(12) << perCall / ticksPerNs
+            << std::setprecision(3) << std::setw(12)
+            << static_cast<double>(c.cycles) / ticksPerNs / 1e6 << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
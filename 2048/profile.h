@@ -0,0 +1,158 @@
+/**
+ * @file profile.h
+ * @brief Счётчики вызовов и времени для горячих функций игры.
+ *
+ * Включается при сборке с GAME_2048_PROFILE (опция CMake PROFILE).
+ * Макрос PROFILE_SCOPE() в начале функции засекает такты процессора
+ * при входе и выходе и прибавляет их к счётчикам текущего потока; общий
+ * итог собирается только при чтении (profileSnapshot(), printProfile()).
+ * Без GAME_2048_PROFILE макрос раскрывается в пустую инструкцию,
+ * и горячий путь не меняется.
+ *
+ * @code
+ * bool moveLeft() {
+ *     PROFILE_SCOPE(MoveLeft);
+ *     return move('a');
+ * }
+ * @endcode
+ */
+
+#ifndef GAME_2048_PROFILE_H
+#define GAME_2048_PROFILE_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Включены ли счётчики в этой сборке.
+ */
+#ifdef GAME_2048_PROFILE
+constexpr bool PROFILE_ENABLED = true;
+#else
+constexpr bool PROFILE_ENABLED = false;
+#endif
+
+/**
+ * @brief Измеряемые участки.
+ */
+enum class ProfilePoint : std::uint8_t {
+    Move,            ///< Game::move(): ход в любом направлении.
+    MoveUp,          ///< moveUp().
+    MoveLeft,        ///< moveLeft().
+    MoveDown,        ///< moveDown().
+    MoveRight,       ///< moveRight().
+    GenerateNumber,  ///< Game::generateNumber().
+    CanMove,         ///< canMove() с переносом глобального состояния.
+    SaveGame,        ///< saveGame().
+    LoadGame,        ///< loadGame().
+    PrintBoard,      ///< printBoard().
+    InputToFrame,    ///< От чтения пачки клавиш до вывода кадра с её результатом.
+    Count
+};
+
+/** @brief Количество измеряемых участков. */
+constexpr std::size_t PROFILE_POINT_COUNT = static_cast<std::size_t>(ProfilePoint::Count);
+
+/**
+ * @brief Счётчики одного участка.
+ */
+struct ProfileCounter {
+    std::uint64_t calls = 0;   ///< Количество вызовов.
+    std::uint64_t cycles = 0;  ///< Суммарное время в тактах cycleCount().
+};
+
+/** @brief Счётчики всех участков (индекс — ProfilePoint). */
+using ProfileSnapshot = std::array<ProfileCounter, PROFILE_POINT_COUNT>;
+
+/**
+ * @brief Счётчик тактов: rdtsc на x86, иначе наносекунды steady_clock.
+ * @return std::uint64_t текущее значение счётчика.
+ */
+inline std::uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief Прибавляет один вызов к счётчикам текущего потока.
+ * @param point Участок.
+ * @param cycles Длительность вызова в тактах cycleCount().
+ * @return void
+ */
+void profileRecord(ProfilePoint point, std::uint64_t cycles);
+
+/**
+ * @brief Сумма счётчиков всех потоков, включая завершившиеся.
+ * @return ProfileSnapshot счётчики.
+ */
+ProfileSnapshot profileSnapshot();
+
+/**
+ * @brief Обнуляет счётчики всех потоков.
+ * @return void
+ *
+ * Вызывается, когда другие потоки не выполняют измеряемый код.
+ */
+void profileReset();
+
+/**
+ * @brief Название участка для отчёта.
+ * @param point Участок.
+ * @return const char* имя функции.
+ */
+const char* profilePointName(ProfilePoint point);
+
+/**
+ * @brief Тактов cycleCount() в наносекунде, оценка с момента запуска.
+ * @return double тактов на наносекунду.
+ */
+double profileTicksPerNs();
+
+/**
+ * @brief Печатает таблицу: вызовы, такты и наносекунды на вызов, общее время.
+ * @param out Поток вывода.
+ * @return void
+ *
+ * Участки без вызовов пропускаются.
+ */
+void printProfile(std::ostream& out);
+
+/**
+ * @brief Засекает время от создания до уничтожения и записывает в profileRecord().
+ */
+class ProfileScope {
+public:
+    /**
+     * @brief Начинает замер.
+     * @param point Участок.
+     */
+    explicit ProfileScope(ProfilePoint point) : point_(point), start_(cycleCount()) {}
+
+    ~ProfileScope() { profileRecord(point_, cycleCount() - start_); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePoint point_;
+    std::uint64_t start_;
+};
+
+#ifdef GAME_2048_PROFILE
+/** @brief Замеряет текущую область видимости как участок ProfilePoint::point. */
+#define PROFILE_SCOPE(point) const ProfileScope profileScope_(ProfilePoint::point)
+#else
+#define PROFILE_SCOPE(point) static_cast<void>(0)
+#endif
+
+#endif
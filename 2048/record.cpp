@@ -0,0 +1,192 @@
+/**
+ * @file record.cpp
+ * @brief Реализация формата записей партий.
+ *
+ * Содержит определение функций, объявленных в record.h.
+ */
+
+#include "record.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "savefile.h"
+
+namespace {
+
+const unsigned char FILE_MAGIC[8] = {'2', '0', '4', '8', 'G', 'R', 'E', 'C'};
+const unsigned char BLOCK_MAGIC[4] = {'G', 'B', 'L', 'K'};
+
+void putVarint(std::vector<unsigned char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+bool getVarint(const unsigned char*& p, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool preadAll(int fd, unsigned char* data, std::size_t size, std::uint64_t offset) {
+    while (size > 0) {
+        ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<std::size_t>(got);
+        offset += static_cast<std::uint64_t>(got);
+    }
+    return true;
+}
+
+}
+
+GameRecordFile::~GameRecordFile() {
+    close();
+}
+
+bool GameRecordFile::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd_ < 0) return false;
+    unsigned char header[RECORD_FILE_HEADER_SIZE] = {};
+    std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+    putLE(header + 8, RECORD_VERSION, 2);
+    putLE(header + 10, BOARD_ENCODING, 2);
+    if (!append(header, sizeof(header))) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GameRecordFile::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+bool GameRecordFile::append(const unsigned char* data, std::size_t size) {
+    if (fd_ < 0) return false;
+    // Дозапись остатка вторым write() могла бы попасть после блока
+    // другого потока, поэтому неполная запись считается ошибкой.
+    ssize_t written = 0;
+    do {
+        written = ::write(fd_, data, size);
+    } while (written < 0 && errno == EINTR);
+    return written >= 0 && static_cast<std::size_t>(written) == size;
+}
+
+GameRecordWriter::GameRecordWriter(GameRecordFile& file, std::size_t blockBytes)
+    : file_(file), blockBytes_(blockBytes) {
+    block_.resize(RECORD_BLOCK_HEADER_SIZE);
+}
+
+GameRecordWriter::~GameRecordWriter() {
+    flush();
+}
+
+void GameRecordWriter::beginGame(std::uint64_t seed) {
+    seed_ = seed;
+    moves_.clear();
+    moveCount_ = 0;
+}
+
+void GameRecordWriter::addMove(Direction dir, int scoreDelta) {
+    putVarint(moves_, (static_cast<std::uint64_t>(scoreDelta / 4) << 2) |
+                          static_cast<std::uint64_t>(dir));
+    ++moveCount_;
+}
+
+void GameRecordWriter::endGame() {
+    std::size_t at = block_.size();
+    block_.resize(at + 8);
+    putLE(block_.data() + at, seed_, 8);
+    putVarint(block_, moveCount_);
+    block_.insert(block_.end(), moves_.begin(), moves_.end());
+    ++games_;
+    if (block_.size() >= blockBytes_) flush();
+}
+
+bool GameRecordWriter::flush() {
+    if (games_ == 0) return true;
+    unsigned char* header = block_.data();
+    std::size_t size = block_.size() - RECORD_BLOCK_HEADER_SIZE;
+    std::memcpy(header, BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+    putLE(header + 4, size, 4);
+    putLE(header + 8, games_, 4);
+    putLE(header + 12, fnv1a(header + RECORD_BLOCK_HEADER_SIZE, size), 4);
+    bool ok = file_.append(block_.data(), block_.size());
+    block_.resize(RECORD_BLOCK_HEADER_SIZE);
+    games_ = 0;
+    return ok;
+}
+
+bool readRecordIndex(int fd, std::vector<RecordBlock>& blocks) {
+    blocks.clear();
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) return false;
+    auto fileSize = static_cast<std::uint64_t>(info.st_size);
+
+    unsigned char header[RECORD_FILE_HEADER_SIZE];
+    if (fileSize < RECORD_FILE_HEADER_SIZE || !preadAll(fd, header, sizeof(header), 0))
+        return false;
+    if (std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        getLE(header + 8, 2) != RECORD_VERSION || getLE(header + 10, 2) != BOARD_ENCODING)
+        return false;
+
+    std::uint64_t offset = RECORD_FILE_HEADER_SIZE;
+    unsigned char blockHeader[RECORD_BLOCK_HEADER_SIZE];
+    while (offset + RECORD_BLOCK_HEADER_SIZE <= fileSize &&
+           preadAll(fd, blockHeader, sizeof(blockHeader), offset)) {
+        if (std::memcmp(blockHeader, BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) != 0) break;
+        RecordBlock block;
+        block.offset = offset + RECORD_BLOCK_HEADER_SIZE;
+        block.size = static_cast<std::uint32_t>(getLE(blockHeader + 4, 4));
+        block.games = static_cast<std::uint32_t>(getLE(blockHeader + 8, 4));
+        block.checksum = static_cast<std::uint32_t>(getLE(blockHeader + 12, 4));
+        if (block.offset + block.size > fileSize) break;
+        blocks.push_back(block);
+        offset = block.offset + block.size;
+    }
+    return true;
+}
+
+bool decodeRecordBlock(const unsigned char* data, const RecordBlock& block,
+                       std::vector<GameRecord>& games) {
+    if (fnv1a(data, block.size) != block.checksum) return false;
+    // Самая короткая запись партии — зерно и varint числа ходов.
+    if (block.games > block.size / (8 + 1)) return false;
+    games.resize(block.games);
+
+    const unsigned char* p = data;
+    const unsigned char* end = data + block.size;
+    for (GameRecord& game : games) {
+        if (end - p < 8) return false;
+        game.seed = getLE(p, 8);
+        p += 8;
+        std::uint64_t count = 0;
+        if (!getVarint(p, end, count) || count > static_cast<std::uint64_t>(end - p))
+            return false;
+        game.moves.resize(count);
+        game.scoreDeltas.resize(count);
+        for (std::uint64_t k = 0; k < count; ++k) {
+            std::uint64_t value = 0;
+            if (!getVarint(p, end, value)) return false;
+            game.moves[k] = static_cast<Direction>(value & 0x3);
+            game.scoreDeltas[k] = static_cast<int>((value >> 2) * 4);
+        }
+    }
+    return p == end;
+}
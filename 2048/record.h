@@ -0,0 +1,198 @@
+/**
+ * @file record.h
+ * @brief Потоковый формат записей партий для последующего анализа.
+ *
+ * Партия записывается как зерно и последовательность ходов: по зерну
+ * Game(seed).startNew() восстанавливает начальное поле, а каждый ход —
+ * это move() и generateNumber(), поэтому поле на любом шаге можно
+ * получить повторной игрой. Вместе с направлением хранится прирост
+ * счёта, чтобы кривые счёта строились без повторной игры.
+ *
+ * Файл: заголовок из 16 байт ("2048GREC", версия формата u16,
+ * BOARD_ENCODING u16, 4 зарезервированных байта) и блоки. Блок —
+ * заголовок из 16 байт ("GBLK", размер данных u32, число партий u32,
+ * FNV-1a данных u32) и записи партий подряд. Запись партии: зерно u64,
+ * число ходов (varint) и по одному varint на ход: (прирост / 4) << 2 | dir.
+ * Все числа — little-endian, varint — LEB128.
+ *
+ * Каждый поток пишет свой блок в свой буфер и дописывает его в файл
+ * одним вызовом write() с O_APPEND, поэтому потоки не ждут друг друга,
+ * а блоки разных потоков не перемешиваются. Блок самодостаточен, и
+ * читатели обрабатывают блоки параллельно.
+ */
+
+#ifndef GAME_2048_RECORD_H
+#define GAME_2048_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * @brief Версия формата записей партий.
+ */
+const std::uint16_t RECORD_VERSION = 1;
+
+/**
+ * @brief Размер заголовка файла в байтах.
+ */
+const std::size_t RECORD_FILE_HEADER_SIZE = 16;
+
+/**
+ * @brief Размер заголовка блока в байтах.
+ */
+const std::size_t RECORD_BLOCK_HEADER_SIZE = 16;
+
+/**
+ * @brief Партия из файла записей.
+ */
+struct GameRecord {
+    std::uint64_t seed = 0;             ///< Зерно Game(seed).
+    std::vector<Direction> moves;       ///< Ходы по порядку.
+    std::vector<int> scoreDeltas;       ///< Прирост счёта за каждый ход.
+};
+
+/**
+ * @brief Положение блока в файле.
+ */
+struct RecordBlock {
+    std::uint64_t offset = 0;   ///< Смещение данных блока (после заголовка).
+    std::uint32_t size = 0;     ///< Размер данных.
+    std::uint32_t games = 0;    ///< Число партий.
+    std::uint32_t checksum = 0; ///< FNV-1a данных.
+};
+
+/**
+ * @brief Файл записей, открытый на дописывание; общий для всех писателей.
+ */
+class GameRecordFile {
+public:
+    GameRecordFile() = default;
+
+    /** @brief Закрывает файл. */
+    ~GameRecordFile();
+
+    GameRecordFile(const GameRecordFile&) = delete;
+    GameRecordFile& operator=(const GameRecordFile&) = delete;
+
+    /**
+     * @brief Создаёт файл (или очищает существующий) и пишет заголовок.
+     * @param path Путь к файлу.
+     * @return bool true, если файл открыт.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Закрывает файл.
+     * @return void
+     */
+    void close();
+
+    /**
+     * @brief Открыт ли файл.
+     * @return bool true, если открыт.
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief Дописывает готовые байты одним вызовом write().
+     * @param data Байты (один или несколько целых блоков).
+     * @param size Количество байтов.
+     * @return bool true, если всё записано; неполная запись — ошибка.
+     *
+     * Потокобезопасна: O_APPEND делает каждую запись атомарной по положению,
+     * а остаток неполной записи не дописывается, чтобы не разорвать блок.
+     */
+    bool append(const unsigned char* data, std::size_t size);
+
+private:
+    int fd_ = -1;
+};
+
+/**
+ * @brief Писатель одного потока: копит партии в блок и сбрасывает его целиком.
+ *
+ * @code
+ * GameRecordWriter writer(file);
+ * writer.beginGame(seed);
+ * writer.addMove(Direction::Left, 4);
+ * writer.endGame();
+ * @endcode
+ */
+class GameRecordWriter {
+public:
+    /**
+     * @brief Создаёт писателя.
+     * @param file Общий файл записей; должен жить дольше писателя.
+     * @param blockBytes Размер блока, после которого он сбрасывается.
+     */
+    explicit GameRecordWriter(GameRecordFile& file, std::size_t blockBytes = 1 << 16);
+
+    /** @brief Сбрасывает незаконченный блок. */
+    ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    /**
+     * @brief Начинает партию.
+     * @param seed Зерно партии.
+     * @return void
+     */
+    void beginGame(std::uint64_t seed);
+
+    /**
+     * @brief Добавляет ход текущей партии.
+     * @param dir Направление.
+     * @param scoreDelta Прирост счёта (кратен 4).
+     * @return void
+     */
+    void addMove(Direction dir, int scoreDelta);
+
+    /**
+     * @brief Завершает партию; при заполнении блока сбрасывает его.
+     * @return void
+     */
+    void endGame();
+
+    /**
+     * @brief Дописывает накопленный блок в файл.
+     * @return bool true, если запись успешна.
+     */
+    bool flush();
+
+private:
+    GameRecordFile& file_;
+    std::size_t blockBytes_;
+    std::vector<unsigned char> block_;
+    std::uint32_t games_ = 0;
+    std::uint64_t seed_ = 0;
+    std::vector<unsigned char> moves_;
+    std::uint64_t moveCount_ = 0;
+};
+
+/**
+ * @brief Читает заголовок файла и заголовки всех блоков.
+ * @param fd Открытый на чтение файл.
+ * @param blocks Сюда записываются найденные блоки.
+ * @return bool false, если заголовок файла неверен.
+ *
+ * Читает только заголовки, переходя от блока к блоку по размеру.
+ * Оборванный последний блок отбрасывается.
+ */
+bool readRecordIndex(int fd, std::vector<RecordBlock>& blocks);
+
+/**
+ * @brief Разбирает данные блока.
+ * @param data Данные блока (без заголовка).
+ * @param block Заголовок блока.
+ * @param games Сюда записываются партии; векторы переиспользуются.
+ * @return bool false, если контрольная сумма или содержимое неверны.
+ */
+bool decodeRecordBlock(const unsigned char* data, const RecordBlock& block,
+                       std::vector<GameRecord>& games);
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file render.cpp
+ * @brief Реализация вывода поля в терминал.
+ *
+ * Содержит определение функций, объявленных в render.h.
+ */
+
+#include "render.h"
+
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace {
+
+const std::string_view CLEAR_SCREEN = "\x1b[H\x1b[2J";
+const std::string_view CLEAR_LINE_TAIL = "\x1b[K";
+const std::string_view CLEAR_BELOW = "\x1b[J";
+
+const int CELL_WIDTH = 5;
+// Текст ячейки по показателю степени, выровненный вправо на CELL_WIDTH.
+const std::array<std::string_view, MAX_EXPONENT + 1> CELL_TEXT = {
+    "    0", "    2", "    4", "    8", "   16", "   32", "   64", "  128",
+    "  256", "  512", " 1024", " 2048", " 4096", " 8192", "16384", "32768"};
+// Строки экрана (с 1): счёт, пустая строка, затем строки поля через одну.
+const int FIRST_BOARD_ROW = 3;
+const int PROMPT_ROW = FIRST_BOARD_ROW + 2 * BOARD_SIZE;
+
+void appendInt(std::string& out, int value) {
+    char digits[16];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    (void)ec;
+    out.append(digits, end);
+}
+
+}
+
+void TerminalRenderer::appendCursor(int row, int col) {
+    buffer_ += "\x1b[";
+    appendInt(buffer_, row);
+    buffer_ += ';';
+    appendInt(buffer_, col);
+    buffer_ += 'H';
+}
+
+void TerminalRenderer::appendScoreLine(int score, int bestScore) {
+    buffer_ += "Score: ";
+    appendInt(buffer_, score);
+    buffer_ += "  Best: ";
+    appendInt(buffer_, bestScore);
+}
+
+void TerminalRenderer::appendCell(int exponent) {
+    buffer_ += CELL_TEXT[static_cast<std::size_t>(exponent)];
+}
+
+std::string_view TerminalRenderer::frame(Board b, int score, int bestScore) {
+    buffer_.clear();
+    if (!valid_) {
+        buffer_ += CLEAR_SCREEN;
+        appendScoreLine(score, bestScore);
+        buffer_ += "\n\n";
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j)
+                appendCell(cellExponent(b, i, j));
+            buffer_ += "\n\n";
+        }
+    } else {
+        if (score != score_ || bestScore != bestScore_) {
+            appendCursor(1, 1);
+            appendScoreLine(score, bestScore);
+            buffer_ += CLEAR_LINE_TAIL;
+        }
+        // В каждой строке поля одно перемещение курсора и ячейки от первой
+        // до последней изменившейся: ход обычно меняет несколько ячеек подряд.
+        Board changed = occupiedMask(b ^ board_);
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            auto row = static_cast<unsigned>((changed >> (16 * i)) & 0x1111);
+            if (row == 0) continue;
+            int first = std::countr_zero(row) / 4;
+            int last = (static_cast<int>(std::bit_width(row)) - 1) / 4;
+            appendCursor(FIRST_BOARD_ROW + 2 * i, 1 + CELL_WIDTH * first);
+            for (int j = first; j <= last; ++j)
+                appendCell(cellExponent(b, i, j));
+        }
+        appendCursor(PROMPT_ROW, 1);
+    }
+    buffer_ += CLEAR_BELOW;
+
+    board_ = b;
+    score_ = score;
+    bestScore_ = bestScore;
+    valid_ = true;
+    return buffer_;
+}
+
+bool writeFrame(std::string_view frame) {
+    std::cout.flush();
+    std::fflush(stdout);
+    while (!frame.empty()) {
+        ssize_t written = ::write(STDOUT_FILENO, frame.data(), frame.size());
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        frame.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+TerminalRenderer& defaultRenderer() {
+    static TerminalRenderer renderer;
+    return renderer;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file render.h
+ * @brief Вывод поля в терминал с перерисовкой только изменившихся ячеек.
+ *
+ * Кадр собирается в одном буфере из управляющих последовательностей
+ * ANSI. Первый кадр очищает экран и рисует поле целиком; следующие
+ * ставят курсор только на ячейки, значение которых изменилось, и на
+ * строку счёта, если изменился счёт. В конце кадра курсор уходит под
+ * поле, и всё ниже него стирается, чтобы подсказки и сообщения не
+ * накапливались. Готовый кадр выводится одним вызовом write().
+ *
+ * Раскладка совпадает с прежним printBoard(): строка счёта, пустая
+ * строка и четыре строки поля через одну, по 5 символов на ячейку.
+ */
+
+#ifndef GAME_2048_RENDER_H
+#define GAME_2048_RENDER_H
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "board.h"
+
+/**
+ * @brief Построитель кадров для одного терминала.
+ *
+ * @code
+ * TerminalRenderer renderer;
+ * writeFrame(renderer.frame(game.board(), game.score(), game.bestScore()));
+ * @endcode
+ */
+class TerminalRenderer {
+public:
+    /**
+     * @brief Собирает кадр, переводящий экран из предыдущего состояния в заданное.
+     * @param b Упакованное поле.
+     * @param score Текущий счёт.
+     * @param bestScore Лучший счёт.
+     * @return std::string_view кадр; действителен до следующего вызова.
+     */
+    std::string_view frame(Board b, int score, int bestScore);
+
+    /**
+     * @brief Считает экран неизвестным: следующий кадр нарисует всё заново.
+     * @return void
+     */
+    void invalidate() { valid_ = false; }
+
+private:
+    void appendCursor(int row, int col);
+    void appendScoreLine(int score, int bestScore);
+    void appendCell(int exponent);
+
+    std::string buffer_;
+    Board board_ = 0;
+    int score_ = 0;
+    int bestScore_ = 0;
+    bool valid_ = false;
+};
+
+/**
+ * @brief Выводит кадр в стандартный вывод одним системным вызовом.
+ * @param frame Кадр.
+ * @return bool true, если кадр записан полностью.
+ *
+ * Перед записью сбрасывает буфер std::cout, чтобы не нарушить порядок
+ * вывода. Если write() записал кадр частично, дописывает остаток.
+ */
+bool writeFrame(std::string_view frame);
+
+/**
+ * @brief Общий построитель кадров для printBoard() и clearScreen().
+ * @return TerminalRenderer& построитель.
+ */
+TerminalRenderer& defaultRenderer();
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file rng.h
+ * @brief Быстрый воспроизводимый генератор случайных чисел.
+ *
+ * xoshiro256** с инициализацией состояния через splitmix64.
+ * Состояние занимает 32 байта, следующий шаг — несколько сдвигов
+ * и умножений, без обращений к системе и выделения памяти.
+ * Одинаковое зерно всегда даёт одинаковую последовательность.
+ */
+
+#ifndef GAME_2048_RNG_H
+#define GAME_2048_RNG_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Один шаг splitmix64: перемешивает 64-битное значение.
+ * @param x Состояние; увеличивается на золотое сечение.
+ * @return std::uint64_t следующее значение.
+ */
+constexpr std::uint64_t splitmix64(std::uint64_t& x) {
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Генератор xoshiro256**.
+ *
+ * Удовлетворяет требованиям UniformRandomBitGenerator, поэтому может
+ * использоваться и со стандартными распределениями.
+ *
+ * @code
+ * Rng rng(42);
+ * std::uint32_t cell = rng.below(16);
+ * @endcode
+ */
+class Rng {
+public:
+    using result_type = std::uint64_t;
+    using State = std::array<std::uint64_t, 4>;
+
+    /**
+     * @brief Создаёт генератор с заданным зерном.
+     * @param seed Зерно.
+     */
+    explicit Rng(std::uint64_t seed = 0) { this->seed(seed); }
+
+    /**
+     * @brief Переинициализирует генератор.
+     * @param seed Зерно.
+     * @return void
+     */
+    void seed(std::uint64_t seed) {
+        for (std::uint64_t& word : state_)
+            word = splitmix64(seed);
+    }
+
+    /**
+     * @brief Следующее 64-битное число.
+     * @return std::uint64_t случайное число.
+     */
+    std::uint64_t next() {
+        std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Случайное число в диапазоне [0, n) без деления.
+     * @param n Верхняя граница (n > 0).
+     * @return std::uint32_t число от 0 до n - 1.
+     */
+    std::uint32_t below(std::uint32_t n) {
+        return static_cast<std::uint32_t>(((next() >> 32) * n) >> 32);
+    }
+
+    /** @brief Следующее число (интерфейс UniformRandomBitGenerator). */
+    result_type operator()() { return next(); }
+    /** @brief Наименьшее возможное значение. */
+    static constexpr result_type min() { return 0; }
+    /** @brief Наибольшее возможное значение. */
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /** @brief Текущее состояние генератора. */
+    const State& state() const { return state_; }
+    /** @brief Восстанавливает состояние генератора. */
+    void setState(const State& state) { state_ = state; }
+
+private:
+    static constexpr std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    State state_{};
+};
+
+#endif
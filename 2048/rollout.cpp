@@ -0,0 +1,137 @@
+/**
+ * @file rollout.cpp
+ * @brief Реализация поиска Монте-Карло.
+ *
+ * Содержит определение функций, объявленных в rollout.h.
+ */
+
+#include "rollout.h"
+
+#include <algorithm>
+
+#include "game.h"
+#include "simulator.h"
+
+namespace {
+
+// Партий в одном блоке: достаточно, чтобы счётчик заданий не был узким местом.
+const std::uint64_t TASK_CHUNK = 8;
+
+}
+
+int randomPlayout(Board b, std::uint64_t seed, std::uint64_t& moves) {
+    Game game(seed);
+    game.setBoard(b);
+    game.generateNumber();
+
+    Rng& rng = game.rng();
+    while (game.canMove()) {
+        Direction legal[4];
+        int count = 0;
+        for (Direction dir : ALL_DIRECTIONS) {
+            int unused = 0;
+            if (moveBoard(game.board(), dir, unused) != game.board())
+                legal[count++] = dir;
+        }
+        game.move(legal[rng.below(static_cast<std::uint32_t>(count))]);
+        game.generateNumber();
+        ++moves;
+    }
+    return game.score();
+}
+
+MonteCarloSearch::MonteCarloSearch(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    partials_.resize(threads);
+    for (unsigned t = 1; t < threads; ++t)
+        pool_.emplace_back([this, t](std::stop_token stop) { workerLoop(stop, t); });
+}
+
+MonteCarloSearch::~MonteCarloSearch() {
+    // request_stop() будит ожидание в workerLoop(), затем jthread ждёт завершения.
+    pool_.clear();
+}
+
+void MonteCarloSearch::workerLoop(std::stop_token stop, unsigned self) {
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex_);
+            if (!wake_.wait(lock, stop, [&] { return generation_ != seen; })) return;
+            seen = generation_;
+        }
+        runTasks(self);
+        {
+            std::lock_guard lock(mutex_);
+            if (--running_ == 0) done_.notify_all();
+        }
+    }
+}
+
+void MonteCarloSearch::runTasks(unsigned self) {
+    Partial& partial = partials_[self];
+    const std::uint64_t total = playouts_ * static_cast<std::uint64_t>(legalCount_);
+    while (true) {
+        std::uint64_t begin = nextTask_.fetch_add(TASK_CHUNK, std::memory_order_relaxed);
+        if (begin >= total) return;
+        std::uint64_t end = std::min(begin + TASK_CHUNK, total);
+        for (std::uint64_t task = begin; task < end; ++task) {
+            std::size_t root = task / playouts_;
+            std::uint64_t index = task % playouts_;
+            auto dir = static_cast<std::size_t>(legal_[root]);
+            int gained = randomPlayout(roots_[root], gameSeed(seed_, 4 * index + dir),
+                                       partial.moves);
+            partial.gain[root] += rootGain_[root] + gained;
+        }
+    }
+}
+
+std::optional<Direction> MonteCarloSearch::bestMove(Board b, int playouts, std::uint64_t seed) {
+    stats_ = RolloutStats{};
+    legalCount_ = 0;
+    for (Direction dir : ALL_DIRECTIONS) {
+        int gained = 0;
+        Board moved = moveBoard(b, dir, gained);
+        if (moved == b) continue;
+        roots_[static_cast<std::size_t>(legalCount_)] = moved;
+        rootGain_[static_cast<std::size_t>(legalCount_)] = gained;
+        legal_[static_cast<std::size_t>(legalCount_)] = dir;
+        ++legalCount_;
+    }
+    if (legalCount_ == 0) return std::nullopt;
+
+    playouts_ = static_cast<std::uint64_t>(std::max(playouts, 1));
+    seed_ = seed;
+    nextTask_.store(0, std::memory_order_relaxed);
+    for (Partial& partial : partials_)
+        partial = Partial{};
+
+    {
+        std::lock_guard lock(mutex_);
+        running_ = static_cast<unsigned>(pool_.size());
+        ++generation_;
+    }
+    wake_.notify_all();
+    runTasks(0);
+    {
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [&] { return running_ == 0; });
+    }
+
+    // Целочисленные суммы не зависят от того, какой поток какую партию сыграл.
+    std::array<std::int64_t, 4> gain{};
+    for (const Partial& partial : partials_) {
+        for (std::size_t r = 0; r < gain.size(); ++r)
+            gain[r] += partial.gain[r];
+        stats_.moves += partial.moves;
+    }
+    stats_.playouts = playouts_ * static_cast<std::uint64_t>(legalCount_);
+
+    std::size_t best = 0;
+    for (std::size_t r = 0; r < static_cast<std::size_t>(legalCount_); ++r) {
+        stats_.meanGain[static_cast<std::size_t>(legal_[r])] =
+            static_cast<double>(gain[r]) / static_cast<double>(playouts_);
+        if (gain[r] > gain[best]) best = r;
+    }
+    return legal_[best];
+}
@@ -0,0 +1,130 @@
+/**
+ * @file rollout.h
+ * @brief Выбор хода методом Монте-Карло: случайные партии до конца игры.
+ *
+ * Для каждого из четырёх направлений выполняется ход, затем K партий
+ * случайной стратегией по правилам generateNumber() до тех пор, пока
+ * canMove() не вернёт false. Выбирается направление с наибольшим
+ * средним итоговым приростом счёта.
+ *
+ * Партии раздаются пулу потоков блоками. Партия j направления d всегда
+ * играется с зерном, выведенным из (seed, 4 * j + d), а суммы счетов
+ * целочисленные, поэтому выбор не зависит от числа потоков и порядка
+ * выполнения.
+ */
+
+#ifndef GAME_2048_ROLLOUT_H
+#define GAME_2048_ROLLOUT_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+
+/**
+ * @brief Статистика последнего выбора хода.
+ */
+struct RolloutStats {
+    std::uint64_t playouts = 0;                 ///< Сыграно случайных партий.
+    std::uint64_t moves = 0;                    ///< Ходов во всех партиях.
+    std::array<double, 4> meanGain{};           ///< Средний прирост счёта по направлениям (индекс — Direction).
+};
+
+/**
+ * @brief Поиск Монте-Карло с собственным пулом потоков.
+ *
+ * Один вызов bestMove() за раз: экземпляр не рассчитан на вызовы из
+ * нескольких потоков одновременно.
+ *
+ * @code
+ * MonteCarloSearch search(4);
+ * auto dir = search.bestMove(game.board(), 200, seed);
+ * if (dir) game.move(*dir);
+ * @endcode
+ */
+class MonteCarloSearch {
+public:
+    /**
+     * @brief Создаёт поиск и запускает потоки пула.
+     * @param threads Количество потоков, включая вызывающий (0 — std::thread::hardware_concurrency()).
+     */
+    explicit MonteCarloSearch(unsigned threads = 0);
+
+    /** @brief Останавливает потоки пула. */
+    ~MonteCarloSearch();
+
+    MonteCarloSearch(const MonteCarloSearch&) = delete;
+    MonteCarloSearch& operator=(const MonteCarloSearch&) = delete;
+
+    /**
+     * @brief Выбирает ход с наибольшим средним счётом случайных партий.
+     * @param b Упакованное поле.
+     * @param playouts Количество партий на каждое направление.
+     * @param seed Зерно; при одинаковом зерне выбор одинаков при любом числе потоков.
+     * @return std::optional<Direction> лучший ход или std::nullopt, если ходов нет.
+     *
+     * При равных суммах выигрывает направление, идущее раньше в ALL_DIRECTIONS.
+     */
+    std::optional<Direction> bestMove(Board b, int playouts, std::uint64_t seed);
+
+    /**
+     * @brief Статистика последнего вызова bestMove().
+     * @return const RolloutStats& статистика.
+     */
+    const RolloutStats& stats() const { return stats_; }
+
+    /**
+     * @brief Количество потоков, включая вызывающий.
+     * @return unsigned число потоков.
+     */
+    unsigned threads() const { return static_cast<unsigned>(partials_.size()); }
+
+private:
+    struct alignas(64) Partial {
+        std::array<std::int64_t, 4> gain{};
+        std::uint64_t moves = 0;
+    };
+
+    void workerLoop(std::stop_token stop, unsigned self);
+    void runTasks(unsigned self);
+
+    std::vector<Partial> partials_;
+
+    // Задание текущего вызова bestMove(): корни по направлениям и счётчик блоков.
+    std::array<Board, 4> roots_{};
+    std::array<int, 4> rootGain_{};
+    std::array<Direction, 4> legal_{};
+    int legalCount_ = 0;
+    std::uint64_t playouts_ = 0;
+    std::uint64_t seed_ = 0;
+    std::atomic<std::uint64_t> nextTask_{0};
+
+    std::mutex mutex_;
+    std::condition_variable_any wake_;
+    std::condition_variable_any done_;
+    std::uint64_t generation_ = 0;
+    unsigned running_ = 0;
+    std::vector<std::jthread> pool_;
+
+    RolloutStats stats_;
+};
+
+/**
+ * @brief Играет одну случайную партию до конца.
+ * @param b Упакованное поле перед появлением числа.
+ * @param seed Зерно партии.
+ * @param moves Счётчик, к которому прибавляется число ходов.
+ * @return int очки, набранные за партию.
+ *
+ * Сначала появляется число, затем случайные ходы среди изменяющих
+ * поле чередуются с generateNumber().
+ */
+int randomPlayout(Board b, std::uint64_t seed, std::uint64_t& moves);
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file savefile.cpp
+ * @brief Реализация двоичного формата сохранения.
+ *
+ * Содержит определение функций, объявленных в savefile.h.
+ */
+
+#include "savefile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned char SAVE_MAGIC[4] = {'2', '0', '4', '8'};
+
+}
+
+void putLE(unsigned char* out, std::uint64_t value, int bytes) {
+    for (int k = 0; k < bytes; ++k)
+        out[k] = static_cast<unsigned char>(value >> (8 * k));
+}
+
+std::uint64_t getLE(const unsigned char* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int k = 0; k < bytes; ++k)
+        value |= static_cast<std::uint64_t>(in[k]) << (8 * k);
+    return value;
+}
+
+std::uint32_t fnv1a(const unsigned char* data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t k = 0; k < size; ++k) {
+        hash ^= data[k];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::array<unsigned char, SAVE_RECORD_SIZE> encodeSaveRecord(const SaveRecord& record) {
+    std::array<unsigned char, SAVE_RECORD_SIZE> out{};
+    unsigned char* p = out.data();
+    std::copy(SAVE_MAGIC, SAVE_MAGIC + 4, p);
+    putLE(p + 4, SAVE_VERSION, 2);
+    putLE(p + 8, record.board, 8);
+    putLE(p + 16, static_cast<std::uint32_t>(record.score), 4);
+    putLE(p + 20, static_cast<std::uint32_t>(record.bestScore), 4);
+    for (int k = 0; k < 4; ++k)
+        putLE(p + 24 + 8 * k, record.rng[static_cast<std::size_t>(k)], 8);
+    putLE(p + 56, fnv1a(p, 56), 4);
+    return out;
+}
+
+bool decodeSaveRecord(const unsigned char* data, std::size_t size, SaveRecord& record) {
+    if (size != SAVE_RECORD_SIZE) return false;
+    if (!std::equal(SAVE_MAGIC, SAVE_MAGIC + 4, data)) return false;
+    if (getLE(data + 4, 2) != SAVE_VERSION) return false;
+    if (getLE(data + 56, 4) != fnv1a(data, 56)) return false;
+
+    record.board = getLE(data + 8, 8);
+    record.score = static_cast<int>(static_cast<std::uint32_t>(getLE(data + 16, 4)));
+    record.bestScore = static_cast<int>(static_cast<std::uint32_t>(getLE(data + 20, 4)));
+    for (int k = 0; k < 4; ++k)
+        record.rng[static_cast<std::size_t>(k)] = getLE(data + 24 + 8 * k, 8);
+    return true;
+}
+
+bool writeFileAtomic(const std::string& path, const void* data, std::size_t size) {
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (f == nullptr) return false;
+    // Данные должны дойти до диска до переименования, иначе после сбоя
+    // на месте сохранения может оказаться пустой файл.
+    bool ok = std::fwrite(data, 1, size, f) == size && std::fflush(f) == 0 &&
+              ::fsync(::fileno(f)) == 0;
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    // Переименование становится постоянным после сброса каталога.
+    std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file savefile.h
+ * @brief Двоичный формат сохранения партии и атомарная запись файлов.
+ *
+ * Запись фиксированного размера (все числа — little-endian):
+ *
+ * | Смещение | Размер | Поле                                  |
+ * |----------|--------|---------------------------------------|
+ * | 0        | 4      | сигнатура "2048"                      |
+ * | 4        | 2      | версия формата                        |
+ * | 6        | 2      | зарезервировано (0)                   |
+ * | 8        | 8      | упакованное поле (см. board.h)        |
+ * | 16       | 4      | счёт                                  |
+ * | 20       | 4      | лучший счёт                           |
+ * | 24       | 32     | состояние генератора (4 x uint64)     |
+ * | 56       | 4      | FNV-1a по байтам 0..55                |
+ *
+ * За записью может следовать блок истории ходов (см. history.h);
+ * Game::load() без истории его не читает.
+ *
+ * Файл записывается во временный файл рядом с целевым и затем
+ * переименовывается, поэтому прерванная запись не портит сохранение.
+ */
+
+#ifndef GAME_2048_SAVEFILE_H
+#define GAME_2048_SAVEFILE_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "board.h"
+#include "rng.h"
+
+/**
+ * @brief Версия двоичного формата сохранения.
+ */
+const std::uint16_t SAVE_VERSION = 1;
+
+/**
+ * @brief Размер записи сохранения в байтах.
+ */
+const std::size_t SAVE_RECORD_SIZE = 60;
+
+/**
+ * @brief Содержимое сохранения.
+ */
+struct SaveRecord {
+    Board board = 0;        ///< Упакованное поле.
+    int score = 0;          ///< Текущий счёт.
+    int bestScore = 0;      ///< Лучший счёт.
+    Rng::State rng{};       ///< Состояние генератора партии.
+};
+
+/**
+ * @brief Кодирует запись в байты.
+ * @param record Содержимое сохранения.
+ * @return std::array<unsigned char, SAVE_RECORD_SIZE> закодированная запись.
+ */
+std::array<unsigned char, SAVE_RECORD_SIZE> encodeSaveRecord(const SaveRecord& record);
+
+/**
+ * @brief Декодирует запись и проверяет сигнатуру, версию и контрольную сумму.
+ * @param data Байты записи.
+ * @param size Количество байтов.
+ * @param record Запись, заполняемая при успехе.
+ * @return bool true, если запись корректна.
+ */
+bool decodeSaveRecord(const unsigned char* data, std::size_t size, SaveRecord& record);
+
+/**
+ * @brief Атомарно заменяет содержимое файла.
+ * @param path Путь к файлу.
+ * @param data Новое содержимое.
+ * @param size Размер содержимого.
+ * @return bool true, если файл записан, переименован и сброшен на диск.
+ *
+ * Данные пишутся в path + ".tmp", сбрасываются на диск (fsync) и
+ * переименовываются в path; затем сбрасывается каталог, чтобы после
+ * сбоя системы на месте path было либо старое, либо новое содержимое.
+ */
+bool writeFileAtomic(const std::string& path, const void* data, std::size_t size);
+
+/**
+ * @brief FNV-1a (32 бита).
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return std::uint32_t хеш.
+ */
+std::uint32_t fnv1a(const unsigned char* data, std::size_t size);
+
+/**
+ * @brief Записывает младшие байты числа в порядке little-endian.
+ * @param out Куда записывать.
+ * @param value Число.
+ * @param bytes Количество байтов (1..8).
+ * @return void
+ */
+void putLE(unsigned char* out, std::uint64_t value, int bytes);
+
+/**
+ * @brief Читает число, записанное в порядке little-endian.
+ * @param in Откуда читать.
+ * @param bytes Количество байтов (1..8).
+ * @return std::uint64_t прочитанное число.
+ */
+std::uint64_t getLE(const unsigned char* in, int bytes);
+
+/**
+ * @brief Порядок байтов машины совпадает с порядком в файлах.
+ *
+ * Файлы, которые отображаются в память как есть (книга ходов, веса
+ * сети n-кортежей), читаются и пишутся только на little-endian машинах.
+ */
+constexpr bool NATIVE_LITTLE_ENDIAN = std::endian::native == std::endian::little;
+
+/**
+ * @brief Читает поле в родном порядке байтов без требований к выравниванию.
+ * @param p Откуда читать.
+ * @return T прочитанное значение.
+ */
+template <typename T>
+T readField(const unsigned char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Записывает поле в родном порядке байтов без требований к выравниванию.
+ * @param p Куда записывать.
+ * @param value Значение.
+ * @return void
+ */
+template <typename T>
+void writeField(unsigned char* p, T value) {
+    std::memcpy(p, &value, sizeof(T));
+}
+
+#endif
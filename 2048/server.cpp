@@ -0,0 +1,488 @@
+/**
+ * @file server.cpp
+ * @brief Реализация сервера партий.
+ *
+ * Содержит определение функций, объявленных в server.h.
+ */
+
+#include "server.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "game.h"
+
+namespace {
+
+const unsigned char STORE_MAGIC[8] = {'2', '0', '4', '8', 'S', 'E', 'S', 'S'};
+const std::size_t STORE_HEADER_SIZE = 16;
+const std::size_t STORE_RECORD_SIZE = 8 + SAVE_RECORD_SIZE;
+// Если клиент не читает ответы, соединение перестаёт читаться, пока
+// очередь ответов не станет меньше этого размера.
+const std::size_t OUTPUT_LIMIT = 1 << 16;
+const int MAX_EVENTS = 256;
+
+void appendRequest(std::uint8_t op, std::uint64_t value, int bytes,
+                   std::vector<unsigned char>& out) {
+    std::size_t at = out.size();
+    out.resize(at + 1 + static_cast<std::size_t>(bytes));
+    out[at] = op;
+    putLE(out.data() + at + 1, value, bytes);
+}
+
+std::size_t requestSize(std::uint8_t op) {
+    switch (op) {
+        case REQUEST_NEW: return 9;
+        case REQUEST_MOVE: return 2;
+        case REQUEST_RESUME: return 9;
+    }
+    return 1;
+}
+
+}
+
+void encodeNewRequest(std::uint64_t seed, std::vector<unsigned char>& out) {
+    appendRequest(REQUEST_NEW, seed, 8, out);
+}
+
+void encodeMoveRequest(Direction dir, std::vector<unsigned char>& out) {
+    appendRequest(REQUEST_MOVE, static_cast<std::uint64_t>(dir), 1, out);
+}
+
+void encodeResumeRequest(std::uint64_t game, std::vector<unsigned char>& out) {
+    appendRequest(REQUEST_RESUME, game, 8, out);
+}
+
+ServerResponse decodeResponse(const unsigned char* data) {
+    ServerResponse response;
+    response.status = data[0];
+    response.flags = data[1];
+    response.score = static_cast<int>(getLE(data + 4, 4));
+    response.board = getLE(data + 8, 8);
+    response.game = getLE(data + 16, 8);
+    return response;
+}
+
+struct GameServer::Session {
+    int fd = -1;
+    std::uint64_t id = 0;   // 0 — партия ещё не начата.
+    Game game{0};
+    bool dirty = false;
+    bool closing = false;   // После отправки ответов соединение закрывается.
+    std::uint32_t events = 0;
+    std::vector<unsigned char> input;
+    std::vector<unsigned char> output;
+    std::size_t sent = 0;
+};
+
+struct GameServer::Loop {
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::unordered_map<int, std::unique_ptr<Session>> sessions;
+    std::atomic<std::uint64_t> connections{0};
+    std::atomic<std::uint64_t> active{0};
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> hangups{0};
+    std::atomic<bool> stopping{false};
+    std::jthread thread;
+
+    ~Loop() {
+        if (epollFd >= 0) ::close(epollFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+    }
+};
+
+GameServer::GameServer(const ServerConfig& config) : config_(config) {}
+
+GameServer::~GameServer() {
+    stop();
+}
+
+bool GameServer::start() {
+    // При нулевом периоде циклы и поток записи крутились бы без ожидания.
+    if (config_.saveInterval.count() <= 0 || !loadStore()) return false;
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (config_.socketPath.empty() || config_.socketPath.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, config_.socketPath.c_str(), config_.socketPath.size() + 1);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+    ::unlink(config_.socketPath.c_str());
+    if (::bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    unsigned count = config_.loops != 0 ? config_.loops
+                                        : std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned k = 0; k < count; ++k) {
+        auto loop = std::make_unique<Loop>();
+        loop->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event listenEvent{};
+        listenEvent.events = EPOLLIN | EPOLLEXCLUSIVE;
+        listenEvent.data.fd = listenFd_;
+        epoll_event wakeEvent{};
+        wakeEvent.events = EPOLLIN;
+        wakeEvent.data.fd = loop->wakeFd;
+        if (loop->epollFd < 0 || loop->wakeFd < 0 ||
+            ::epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, listenFd_, &listenEvent) != 0 ||
+            ::epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &wakeEvent) != 0) {
+            loops_.clear();
+            ::close(listenFd_);
+            listenFd_ = -1;
+            return false;
+        }
+        loops_.push_back(std::move(loop));
+    }
+    for (auto& loop : loops_)
+        loop->thread = std::jthread([this, raw = loop.get()] { runLoop(*raw); });
+    if (!config_.storePath.empty())
+        saver_ = std::jthread([this](std::stop_token stop) { saverLoop(stop); });
+    return true;
+}
+
+void GameServer::stop() {
+    if (listenFd_ < 0) return;
+    for (auto& loop : loops_) {
+        loop->stopping.store(true, std::memory_order_relaxed);
+        std::uint64_t one = 1;
+        ssize_t woken = ::write(loop->wakeFd, &one, sizeof(one));
+        static_cast<void>(woken);
+    }
+    for (auto& loop : loops_)
+        if (loop->thread.joinable()) loop->thread.join();
+    if (saver_.joinable()) {
+        saver_.request_stop();
+        saver_.join();
+    }
+    if (!config_.storePath.empty()) writeStore();
+    loops_.clear();
+    ::close(listenFd_);
+    listenFd_ = -1;
+    ::unlink(config_.socketPath.c_str());
+}
+
+ServerStats GameServer::stats() const {
+    ServerStats total;
+    for (const auto& loop : loops_) {
+        total.connections += loop->connections.load(std::memory_order_relaxed);
+        total.active += loop->active.load(std::memory_order_relaxed);
+        total.requests += loop->requests.load(std::memory_order_relaxed);
+        total.hangups += loop->hangups.load(std::memory_order_relaxed);
+    }
+    total.saves = saves_.load(std::memory_order_relaxed);
+    return total;
+}
+
+void GameServer::runLoop(Loop& loop) {
+    using Clock = std::chrono::steady_clock;
+    epoll_event events[MAX_EVENTS];
+    auto nextCollect = Clock::now() + config_.saveInterval;
+    while (!loop.stopping.load(std::memory_order_relaxed)) {
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextCollect - Clock::now());
+        int timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0));
+        int count = ::epoll_wait(loop.epollFd, events, MAX_EVENTS, timeout);
+        for (int k = 0; k < count; ++k) {
+            int fd = events[k].data.fd;
+            if (fd == listenFd_) {
+                acceptAll(loop);
+                continue;
+            }
+            if (fd == loop.wakeFd) continue;
+            auto it = loop.sessions.find(fd);
+            if (it == loop.sessions.end()) continue;
+            Session& session = *it->second;
+            if ((events[k].events & (EPOLLHUP | EPOLLERR)) != 0 &&
+                (events[k].events & EPOLLIN) == 0) {
+                closeSession(loop, fd);
+                continue;
+            }
+            if ((events[k].events & EPOLLIN) != 0) readSession(loop, session);
+            else if ((events[k].events & EPOLLOUT) != 0 && !flushOutput(loop, session))
+                closeSession(loop, fd);
+        }
+        if (Clock::now() >= nextCollect) {
+            collectSnapshots(loop);
+            nextCollect = Clock::now() + config_.saveInterval;
+        }
+    }
+
+    std::vector<int> fds;
+    for (const auto& entry : loop.sessions) fds.push_back(entry.first);
+    for (int fd : fds) closeSession(loop, fd);
+}
+
+void GameServer::acceptAll(Loop& loop) {
+    while (true) {
+        int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        auto session = std::make_unique<Session>();
+        session->fd = fd;
+        session->events = EPOLLIN;
+        epoll_event event{};
+        event.events = session->events;
+        event.data.fd = fd;
+        if (::epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        loop.sessions.emplace(fd, std::move(session));
+        loop.connections.fetch_add(1, std::memory_order_relaxed);
+        loop.active.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void GameServer::readSession(Loop& loop, Session& session) {
+    unsigned char buffer[16384];
+    bool eof = false;
+    while (true) {
+        ssize_t got = ::read(session.fd, buffer, sizeof(buffer));
+        if (got > 0) {
+            session.input.insert(session.input.end(), buffer, buffer + got);
+            if (session.output.size() - session.sent >= OUTPUT_LIMIT) break;
+            continue;
+        }
+        if (got == 0) eof = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN) eof = true;
+        break;
+    }
+    handleRequests(loop, session);
+    // Клиент больше ничего не пришлёт: оставшиеся ответы дописываются
+    // по EPOLLOUT, а EPOLLIN снимается, иначе EOF будил бы цикл снова.
+    if (eof) {
+        session.closing = true;
+        loop.hangups.fetch_add(1, std::memory_order_relaxed);
+    }
+    int fd = session.fd;
+    if (!flushOutput(loop, session)) closeSession(loop, fd);
+}
+
+void GameServer::handleRequests(Loop& loop, Session& session) {
+    std::size_t pos = 0;
+    std::uint64_t handled = 0;
+    while (pos < session.input.size() && !session.closing) {
+        const unsigned char* request = session.input.data() + pos;
+        std::size_t size = requestSize(request[0]);
+        if (session.input.size() - pos < size) break;
+        pos += size;
+        ++handled;
+
+        std::uint8_t status = RESPONSE_OK;
+        std::uint8_t flags = 0;
+        switch (request[0]) {
+            case REQUEST_NEW: {
+                if (session.id != 0) {
+                    std::lock_guard lock(storeMutex_);
+                    store_[session.id] = session.game.snapshot();
+                    attached_.erase(session.id);
+                    storeDirty_ = true;
+                }
+                session.game = Game(getLE(request + 1, 8));
+                session.game.startNew();
+                session.id = nextGame_.fetch_add(1, std::memory_order_relaxed);
+                session.dirty = true;
+                std::lock_guard lock(storeMutex_);
+                attached_.insert(session.id);
+                break;
+            }
+            case REQUEST_MOVE:
+                if (session.id == 0) {
+                    status = RESPONSE_NO_GAME;
+                } else if (request[1] > 3) {
+                    status = RESPONSE_BAD_REQUEST;
+                    session.closing = true;
+                } else if (session.game.move(static_cast<Direction>(request[1]))) {
+                    session.game.generateNumber();
+                    session.dirty = true;
+                    flags |= RESPONSE_MOVED;
+                }
+                break;
+            case REQUEST_RESUME: {
+                std::uint64_t id = getLE(request + 1, 8);
+                std::lock_guard lock(storeMutex_);
+                auto it = store_.find(id);
+                if (it == store_.end() || attached_.count(id) != 0 || id == session.id) {
+                    status = RESPONSE_UNKNOWN_GAME;
+                    break;
+                }
+                if (session.id != 0) {
+                    store_[session.id] = session.game.snapshot();
+                    attached_.erase(session.id);
+                    storeDirty_ = true;
+                }
+                session.game.restore(it->second);
+                session.id = id;
+                attached_.insert(id);
+                break;
+            }
+            default:
+                status = RESPONSE_BAD_REQUEST;
+                session.closing = true;
+        }
+        if (session.id != 0 && !session.game.canMove()) flags |= RESPONSE_GAME_OVER;
+
+        std::size_t at = session.output.size();
+        session.output.resize(at + RESPONSE_SIZE);
+        unsigned char* response = session.output.data() + at;
+        response[0] = status;
+        response[1] = flags;
+        putLE(response + 2, 0, 2);
+        putLE(response + 4, static_cast<std::uint32_t>(session.game.score()), 4);
+        putLE(response + 8, session.id != 0 ? session.game.board() : 0, 8);
+        putLE(response + 16, session.id, 8);
+    }
+    session.input.erase(session.input.begin(),
+                        session.input.begin() + static_cast<std::ptrdiff_t>(pos));
+    loop.requests.fetch_add(handled, std::memory_order_relaxed);
+}
+
+bool GameServer::flushOutput(Loop& loop, Session& session) {
+    while (session.sent < session.output.size()) {
+        // MSG_NOSIGNAL: закрытый клиентом сокет даёт EPIPE, а не SIGPIPE.
+        ssize_t written = ::send(session.fd, session.output.data() + session.sent,
+                                 session.output.size() - session.sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && errno == EAGAIN) break;
+        if (written <= 0) return false;
+        session.sent += static_cast<std::size_t>(written);
+    }
+    std::size_t pending = session.output.size() - session.sent;
+    if (pending == 0) {
+        session.output.clear();
+        session.sent = 0;
+        if (session.closing) return false;
+    }
+
+    bool readable = pending < OUTPUT_LIMIT && !session.closing;
+    std::uint32_t events = (readable ? EPOLLIN : 0u) | (pending != 0 ? EPOLLOUT : 0u);
+    if (events != session.events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = session.fd;
+        if (::epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, session.fd, &event) != 0) return false;
+        session.events = events;
+    }
+    return true;
+}
+
+void GameServer::closeSession(Loop& loop, int fd) {
+    auto it = loop.sessions.find(fd);
+    if (it == loop.sessions.end()) return;
+    Session& session = *it->second;
+    if (session.id != 0) {
+        // Законченные партии продолжить нельзя, поэтому они не хранятся.
+        std::lock_guard lock(storeMutex_);
+        if (session.game.canMove()) store_[session.id] = session.game.snapshot();
+        else store_.erase(session.id);
+        attached_.erase(session.id);
+        storeDirty_ = true;
+    }
+    storeChanged_.notify_one();
+    ::epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    loop.sessions.erase(it);
+    loop.active.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void GameServer::collectSnapshots(Loop& loop) {
+    std::vector<std::pair<std::uint64_t, SaveRecord>> snapshots;
+    for (auto& entry : loop.sessions) {
+        Session& session = *entry.second;
+        if (!session.dirty) continue;
+        snapshots.emplace_back(session.id, session.game.snapshot());
+        session.dirty = false;
+    }
+    if (snapshots.empty()) return;
+    {
+        std::lock_guard lock(storeMutex_);
+        for (const auto& [id, record] : snapshots) store_[id] = record;
+        storeDirty_ = true;
+    }
+    storeChanged_.notify_one();
+}
+
+void GameServer::saverLoop(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        {
+            std::unique_lock lock(storeMutex_);
+            storeChanged_.wait(lock, stop, [this] { return storeDirty_; });
+        }
+        if (stop.stop_requested()) return;
+        writeStore();
+        // Не чаще раза в saveInterval, даже если партии закрываются непрерывно.
+        std::unique_lock lock(storeMutex_);
+        storeChanged_.wait_for(lock, stop, config_.saveInterval, [] { return false; });
+    }
+}
+
+bool GameServer::loadStore() {
+    std::lock_guard lock(storeMutex_);
+    store_.clear();
+    attached_.clear();
+    if (config_.storePath.empty()) return true;
+    std::ifstream in(config_.storePath, std::ios::binary);
+    if (!in.is_open()) return true;
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)),
+                                    std::istreambuf_iterator<char>());
+    if (data.size() < STORE_HEADER_SIZE ||
+        !std::equal(STORE_MAGIC, STORE_MAGIC + 8, data.begin()) ||
+        getLE(data.data() + 8, 2) != SESSION_STORE_VERSION)
+        return false;
+
+    std::uint64_t count = getLE(data.data() + 12, 4);
+    std::uint64_t maxId = 0;
+    for (std::uint64_t k = 0; k < count; ++k) {
+        std::size_t at = STORE_HEADER_SIZE + k * STORE_RECORD_SIZE;
+        if (at + STORE_RECORD_SIZE > data.size()) break;
+        SaveRecord record;
+        if (!decodeSaveRecord(data.data() + at + 8, SAVE_RECORD_SIZE, record)) continue;
+        std::uint64_t id = getLE(data.data() + at, 8);
+        store_[id] = record;
+        maxId = std::max(maxId, id);
+    }
+    nextGame_.store(maxId + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool GameServer::writeStore() {
+    std::vector<unsigned char> data;
+    {
+        std::lock_guard lock(storeMutex_);
+        std::array<unsigned char, STORE_HEADER_SIZE> header{};
+        std::copy(STORE_MAGIC, STORE_MAGIC + 8, header.begin());
+        putLE(header.data() + 8, SESSION_STORE_VERSION, 2);
+        putLE(header.data() + 12, store_.size(), 4);
+        data.reserve(STORE_HEADER_SIZE + store_.size() * STORE_RECORD_SIZE);
+        data.insert(data.end(), header.begin(), header.end());
+        for (const auto& [id, record] : store_) {
+            unsigned char key[8];
+            putLE(key, id, 8);
+            auto bytes = encodeSaveRecord(record);
+            data.insert(data.end(), key, key + 8);
+            data.insert(data.end(), bytes.begin(), bytes.end());
+        }
+        storeDirty_ = false;
+    }
+    bool ok = writeFileAtomic(config_.storePath, data.data(), data.size());
+    if (ok) saves_.fetch_add(1, std::memory_order_relaxed);
+    return ok;
+}
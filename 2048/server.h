@@ -0,0 +1,223 @@
+/**
+ * @file server.h
+ * @brief Сервер множества партий на сокете Unix и его двоичный протокол.
+ *
+ * Одно соединение — одна партия. Запрос начинается с байта операции:
+ * - REQUEST_NEW (1 + u64 зерно) — новая партия Game(seed).startNew();
+ * - REQUEST_MOVE (1 + u8 Direction) — ход и generateNumber(), если поле изменилось;
+ * - REQUEST_RESUME (1 + u64 номер партии) — продолжить сохранённую партию.
+ *
+ * На каждый запрос приходит ответ из RESPONSE_SIZE байт: статус u8,
+ * флаги u8 (RESPONSE_MOVED, RESPONSE_GAME_OVER), резерв u16, счёт u32,
+ * поле u64, номер партии u64. Все числа — little-endian. Запросы можно
+ * отправлять пачкой, не дожидаясь ответов: ответы приходят по порядку.
+ *
+ * Соединения обслуживают циклы событий epoll, по одному на поток.
+ * Слушающий сокет добавлен в каждый цикл с EPOLLEXCLUSIVE, так что
+ * ядро раздаёт новые соединения циклам, и дальше соединение живёт в
+ * своём цикле без блокировок. Сокеты неблокирующие.
+ *
+ * Партии не пишут файлов сами. Раз в saveInterval каждый цикл отдаёт
+ * снимки изменившихся партий (Game::snapshot()) в общее хранилище, а
+ * отдельный поток записывает все партии одним файлом через
+ * writeFileAtomic(). Файл: заголовок из 16 байт ("2048SESS", версия
+ * u16, резерв u16, число партий u32) и записи по 68 байт: номер партии
+ * u64 и запись сохранения (см. savefile.h).
+ */
+
+#ifndef GAME_2048_SERVER_H
+#define GAME_2048_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "board.h"
+#include "savefile.h"
+
+/**
+ * @brief Операции запроса.
+ */
+enum RequestOp : std::uint8_t {
+    REQUEST_NEW = 1,     ///< Новая партия; далее u64 зерно.
+    REQUEST_MOVE = 2,    ///< Ход; далее u8 Direction.
+    REQUEST_RESUME = 3,  ///< Продолжить партию; далее u64 номер партии.
+};
+
+/**
+ * @brief Статус ответа.
+ */
+enum ResponseStatus : std::uint8_t {
+    RESPONSE_OK = 0,            ///< Запрос выполнен.
+    RESPONSE_NO_GAME = 1,       ///< Ход до REQUEST_NEW или REQUEST_RESUME.
+    RESPONSE_UNKNOWN_GAME = 2,  ///< Партии с таким номером нет (или она уже открыта).
+    RESPONSE_BAD_REQUEST = 3,   ///< Неизвестная операция; соединение закрывается.
+};
+
+/** @brief Флаг ответа: ход изменил поле. */
+const std::uint8_t RESPONSE_MOVED = 1;
+/** @brief Флаг ответа: ходов больше нет. */
+const std::uint8_t RESPONSE_GAME_OVER = 2;
+
+/** @brief Размер ответа в байтах. */
+const std::size_t RESPONSE_SIZE = 24;
+
+/** @brief Наибольший размер запроса в байтах. */
+const std::size_t MAX_REQUEST_SIZE = 9;
+
+/**
+ * @brief Версия файла партий сервера.
+ */
+const std::uint16_t SESSION_STORE_VERSION = 1;
+
+/**
+ * @brief Разобранный ответ.
+ */
+struct ServerResponse {
+    std::uint8_t status = RESPONSE_OK;  ///< ResponseStatus.
+    std::uint8_t flags = 0;             ///< RESPONSE_MOVED | RESPONSE_GAME_OVER.
+    int score = 0;                      ///< Счёт партии.
+    Board board = 0;                    ///< Поле после запроса.
+    std::uint64_t game = 0;             ///< Номер партии для REQUEST_RESUME.
+};
+
+/**
+ * @brief Кодирует REQUEST_NEW.
+ * @param seed Зерно партии.
+ * @param out Буфер, к которому дописывается запрос.
+ * @return void
+ */
+void encodeNewRequest(std::uint64_t seed, std::vector<unsigned char>& out);
+
+/**
+ * @brief Кодирует REQUEST_MOVE.
+ * @param dir Направление.
+ * @param out Буфер, к которому дописывается запрос.
+ * @return void
+ */
+void encodeMoveRequest(Direction dir, std::vector<unsigned char>& out);
+
+/**
+ * @brief Кодирует REQUEST_RESUME.
+ * @param game Номер партии из прежнего ответа.
+ * @param out Буфер, к которому дописывается запрос.
+ * @return void
+ */
+void encodeResumeRequest(std::uint64_t game, std::vector<unsigned char>& out);
+
+/**
+ * @brief Декодирует ответ.
+ * @param data RESPONSE_SIZE байт ответа.
+ * @return ServerResponse разобранный ответ.
+ */
+ServerResponse decodeResponse(const unsigned char* data);
+
+/**
+ * @brief Параметры сервера.
+ */
+struct ServerConfig {
+    std::string socketPath;                                 ///< Путь сокета Unix.
+    unsigned loops = 0;                                     ///< Циклов событий (0 — по числу ядер).
+    std::string storePath;                                  ///< Файл партий; пусто — только в памяти.
+    std::chrono::milliseconds saveInterval{1000};           ///< Период сбора снимков (больше нуля).
+};
+
+/**
+ * @brief Счётчики сервера.
+ */
+struct ServerStats {
+    std::uint64_t connections = 0;  ///< Открыто соединений всего.
+    std::uint64_t active = 0;       ///< Открыто сейчас.
+    std::uint64_t requests = 0;     ///< Обработано запросов.
+    std::uint64_t saves = 0;        ///< Записей файла партий.
+    std::uint64_t hangups = 0;      ///< Чтений, заставших конец потока клиента.
+};
+
+/**
+ * @brief Сервер партий.
+ *
+ * @code
+ * GameServer server({"/tmp/2048.sock", 0, "sessions.bin", std::chrono::milliseconds(1000)});
+ * if (!server.start()) return 1;
+ * // ...
+ * server.stop();
+ * @endcode
+ */
+class GameServer {
+public:
+    /**
+     * @brief Создаёт сервер; сокет открывается в start().
+     * @param config Параметры.
+     */
+    explicit GameServer(const ServerConfig& config);
+
+    /** @brief Останавливает сервер. */
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    /**
+     * @brief Читает файл партий, открывает сокет и запускает циклы.
+     * @return bool false, если сокет не удалось открыть или saveInterval не больше нуля.
+     */
+    bool start();
+
+    /**
+     * @brief Закрывает соединения, сохраняет все партии и ждёт потоки.
+     * @return void
+     */
+    void stop();
+
+    /**
+     * @brief Сумма счётчиков всех циклов.
+     * @return ServerStats счётчики.
+     */
+    ServerStats stats() const;
+
+    /**
+     * @brief Число циклов событий.
+     * @return unsigned количество потоков циклов.
+     */
+    unsigned loops() const { return static_cast<unsigned>(loops_.size()); }
+
+private:
+    struct Loop;
+    struct Session;
+
+    void runLoop(Loop& loop);
+    void acceptAll(Loop& loop);
+    void readSession(Loop& loop, Session& session);
+    void handleRequests(Loop& loop, Session& session);
+    bool flushOutput(Loop& loop, Session& session);
+    void closeSession(Loop& loop, int fd);
+    void collectSnapshots(Loop& loop);
+    void saverLoop(std::stop_token stop);
+    bool loadStore();
+    bool writeStore();
+
+    ServerConfig config_;
+    int listenFd_ = -1;
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<std::uint64_t> nextGame_{1};
+
+    // Хранилище снимков: номер партии -> снимок; общее для циклов и потока записи.
+    std::mutex storeMutex_;
+    std::condition_variable_any storeChanged_;
+    std::unordered_map<std::uint64_t, SaveRecord> store_;
+    std::unordered_set<std::uint64_t> attached_;
+    bool storeDirty_ = false;
+    std::atomic<std::uint64_t> saves_{0};
+    std::jthread saver_;
+};
+
+#endif
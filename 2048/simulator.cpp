@@ -0,0 +1,161 @@
+/**
+ * @file simulator.cpp
+ * @brief Реализация параллельной самоигры.
+ *
+ * Содержит определение функций, объявленных в simulator.h.
+ */
+
+#include "simulator.h"
+#include "rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+namespace {
+
+// Диапазон номеров партий [next, end), упакованный в одно слово,
+// чтобы владелец и перехватчик меняли его одной операцией CAS.
+struct alignas(64) WorkRange {
+    std::atomic<std::uint64_t> bounds{0};
+};
+
+constexpr std::uint64_t packRange(std::uint32_t next, std::uint32_t end) {
+    return (static_cast<std::uint64_t>(end) << 32) | next;
+}
+
+bool takeOwn(WorkRange& range, std::uint32_t& index) {
+    std::uint64_t cur = range.bounds.load(std::memory_order_relaxed);
+    while (true) {
+        auto next = static_cast<std::uint32_t>(cur);
+        auto end = static_cast<std::uint32_t>(cur >> 32);
+        if (next >= end) return false;
+        if (range.bounds.compare_exchange_weak(cur, packRange(next + 1, end),
+                                               std::memory_order_acq_rel)) {
+            index = next;
+            return true;
+        }
+    }
+}
+
+// Забирает верхнюю половину чужого диапазона.
+bool steal(WorkRange& victim, std::uint32_t& begin, std::uint32_t& end) {
+    std::uint64_t cur = victim.bounds.load(std::memory_order_relaxed);
+    while (true) {
+        auto next = static_cast<std::uint32_t>(cur);
+        auto last = static_cast<std::uint32_t>(cur >> 32);
+        if (next >= last) return false;
+        std::uint32_t mid = next + (last - next) / 2;
+        if (victim.bounds.compare_exchange_weak(cur, packRange(next, mid),
+                                                std::memory_order_acq_rel)) {
+            begin = mid;
+            end = last;
+            return true;
+        }
+    }
+}
+
+struct alignas(64) WorkerStats {
+    std::uint64_t moves = 0;
+    std::vector<int> scores;
+    std::array<std::uint64_t, 16> maxTileHistogram{};
+};
+
+void runWorker(unsigned self, std::vector<WorkRange>& ranges, const SimConfig& config,
+               const PolicyFactory& factory, GameRecordFile& records, WorkerStats& stats) {
+    std::unique_ptr<Policy> policy = factory();
+    std::optional<GameRecordWriter> writer;
+    if (records.isOpen()) writer.emplace(records);
+    auto workers = static_cast<unsigned>(ranges.size());
+    while (true) {
+        std::uint32_t index;
+        if (takeOwn(ranges[self], index)) {
+            GameResult result = playGame(*policy, gameSeed(config.seed, index),
+                                         writer ? &*writer : nullptr);
+            stats.moves += result.moves;
+            stats.scores.push_back(result.score);
+            ++stats.maxTileHistogram[static_cast<std::size_t>(result.maxExponent)];
+            continue;
+        }
+
+        bool stolen = false;
+        for (unsigned k = 1; k < workers && !stolen; ++k) {
+            std::uint32_t begin, end;
+            if (steal(ranges[(self + k) % workers], begin, end)) {
+                ranges[self].bounds.store(packRange(begin, end), std::memory_order_release);
+                stolen = true;
+            }
+        }
+        if (!stolen) return;
+    }
+}
+
+}
+
+std::uint64_t gameSeed(std::uint64_t baseSeed, std::uint64_t index) {
+    // splitmix64: соседние номера дают независимые зёрна.
+    std::uint64_t x = baseSeed + index * 0x9E3779B97F4A7C15ULL;
+    return splitmix64(x);
+}
+
+GameResult playGame(Policy& policy, std::uint64_t seed, GameRecordWriter* record) {
+    Game game(seed);
+    policy.newGame(seed);
+    game.startNew();
+    if (record) record->beginGame(seed);
+
+    GameResult result;
+    while (game.canMove()) {
+        Direction dir = policy.chooseMove(game);
+        int before = game.score();
+        if (!game.move(dir)) break;
+        game.generateNumber();
+        ++result.moves;
+        if (record) record->addMove(dir, game.score() - before);
+    }
+    if (record) record->endGame();
+    result.score = game.score();
+    result.maxExponent = maxExponent(game.board());
+    return result;
+}
+
+SimReport runSimulation(const SimConfig& config, const PolicyFactory& factory) {
+    unsigned threads = config.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, std::max<std::uint32_t>(config.games, 1));
+
+    std::vector<WorkRange> ranges(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        auto begin = static_cast<std::uint32_t>(std::uint64_t{config.games} * t / threads);
+        auto end = static_cast<std::uint32_t>(std::uint64_t{config.games} * (t + 1) / threads);
+        ranges[t].bounds.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    GameRecordFile records;
+    if (!config.recordPath.empty()) records.open(config.recordPath);
+
+    std::vector<WorkerStats> stats(threads);
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned t = 0; t < threads; ++t)
+            pool.emplace_back(runWorker, t, std::ref(ranges), std::cref(config),
+                              std::cref(factory), std::ref(records), std::ref(stats[t]));
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    SimReport report;
+    report.threads = threads;
+    report.seconds = std::chrono::duration<double>(finish - start).count();
+    for (const WorkerStats& s : stats) {
+        report.moves += s.moves;
+        report.scores.insert(report.scores.end(), s.scores.begin(), s.scores.end());
+        for (std::size_t e = 0; e < s.maxTileHistogram.size(); ++e)
+            report.maxTileHistogram[e] += s.maxTileHistogram[e];
+    }
+    report.games = report.scores.size();
+    std::sort(report.scores.begin(), report.scores.end());
+    return report;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file simulator.h
+ * @brief Параллельная самоигра без интерфейса.
+ *
+ * Партии распределяются между потоками планировщиком с перехватом
+ * работы: каждый поток берёт партии из своего диапазона номеров,
+ * а опустев, забирает половину чужого. Каждый поток ведёт свою
+ * статистику, объединение происходит один раз в конце.
+ * Результат не зависит от числа потоков: партия с номером i
+ * всегда играется с зерном, выведенным из (seed, i).
+ * Партии можно записывать в файл (см. record.h): у каждого потока
+ * свой писатель, и потоки не ждут друг друга.
+ */
+
+#ifndef GAME_2048_SIMULATOR_H
+#define GAME_2048_SIMULATOR_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "policy.h"
+#include "record.h"
+
+/**
+ * @brief Параметры симуляции.
+ */
+struct SimConfig {
+    std::uint32_t games = 1000;  ///< Количество партий.
+    unsigned threads = 0;        ///< Количество потоков (0 — std::thread::hardware_concurrency()).
+    std::uint64_t seed = 1;      ///< Базовое зерно.
+    std::string recordPath;      ///< Файл записей партий (см. record.h); пусто — не записывать.
+};
+
+/**
+ * @brief Итог одной партии.
+ */
+struct GameResult {
+    int score = 0;          ///< Итоговый счёт.
+    int maxExponent = 0;    ///< Показатель степени старшей плитки.
+    std::uint64_t moves = 0; ///< Количество выполненных ходов.
+};
+
+/**
+ * @brief Сводная статистика симуляции.
+ */
+struct SimReport {
+    std::uint64_t games = 0;                       ///< Сыграно партий.
+    std::uint64_t moves = 0;                       ///< Всего ходов.
+    double seconds = 0.0;                          ///< Время работы.
+    unsigned threads = 0;                          ///< Использовано потоков.
+    std::vector<int> scores;                       ///< Счета всех партий по возрастанию.
+    std::array<std::uint64_t, 16> maxTileHistogram{}; ///< Число партий по старшей плитке (индекс — показатель).
+};
+
+/**
+ * @brief Играет одну партию до конца.
+ * @param policy Стратегия выбора хода.
+ * @param seed Зерно партии.
+ * @param record Писатель записей партий или nullptr.
+ * @return GameResult итог партии.
+ */
+GameResult playGame(Policy& policy, std::uint64_t seed, GameRecordWriter* record = nullptr);
+
+/**
+ * @brief Зерно партии с заданным номером.
+ * @param baseSeed Базовое зерно симуляции.
+ * @param index Номер партии.
+ * @return std::uint64_t зерно партии.
+ */
+std::uint64_t gameSeed(std::uint64_t baseSeed, std::uint64_t index);
+
+/**
+ * @brief Играет config.games партий во всех потоках.
+ * @param config Параметры симуляции.
+ * @param factory Фабрика стратегии; вызывается один раз на поток.
+ * @return SimReport сводная статистика.
+ *
+ * Если config.recordPath не удаётся открыть, партии играются без записи.
+ *
+ * @code
+ * SimReport report = runSimulation({10000, 0, 42, {}}, policyByName("random"));
+ * @endcode
+ */
+SimReport runSimulation(const SimConfig& config, const PolicyFactory& factory);
+
+#endif
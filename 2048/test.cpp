@@ -1,6 +1,98 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "2048.h"
+#include "ai.h"
+#include "arena.h"
+#include "batch.h"
+#include "book.h"
+#include "generic_board.h"
+#include "history.h"
+#include "input.h"
+#include "journal.h"
+#include "ntuple.h"
+#include "profile.h"
+#include "record.h"
+#include "render.h"
+#include "rollout.h"
+#include "server.h"
+#include "trainer.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Исходная реализация ходов над массивом, используется как эталон.
+bool referenceMove(int cells[BOARD_SIZE][BOARD_SIZE], char dir, int& points) {
+    bool moved = false;
+    for (int line = 0; line < BOARD_SIZE; ++line) {
+        int* ptrs[BOARD_SIZE];
+        for (int k = 0; k < BOARD_SIZE; ++k) {
+            switch (dir) {
+                case 'a': ptrs[k] = &cells[line][k]; break;
+                case 'd': ptrs[k] = &cells[line][BOARD_SIZE - 1 - k]; break;
+                case 'w': ptrs[k] = &cells[k][line]; break;
+                default: ptrs[k] = &cells[BOARD_SIZE - 1 - k][line]; break;
+            }
+        }
+        int temp[BOARD_SIZE] = {};
+        int idx = 0;
+        for (int k = 0; k < BOARD_SIZE; ++k) {
+            if (*ptrs[k] == 0) continue;
+            if (temp[idx] == 0) {
+                temp[idx] = *ptrs[k];
+            } else if (temp[idx] == *ptrs[k]) {
+                temp[idx++] *= 2;
+                points += temp[idx - 1];
+            } else {
+                if (++idx < BOARD_SIZE)
+                    temp[idx] = *ptrs[k];
+            }
+        }
+        for (int k = 0; k < BOARD_SIZE; ++k) {
+            if (*ptrs[k] != temp[k]) moved = true;
+            *ptrs[k] = temp[k];
+        }
+    }
+    return moved;
+}
+
+bool referenceCanMove(const int cells[BOARD_SIZE][BOARD_SIZE]) {
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            if (cells[i][j] == 0)
+                return true;
+            if (i + 1 < BOARD_SIZE && cells[i][j] == cells[i + 1][j])
+                return true;
+            if (j + 1 < BOARD_SIZE && cells[i][j] == cells[i][j + 1])
+                return true;
+        }
+    return false;
+}
+
+void randomCells(std::mt19937& gen, int cells[BOARD_SIZE][BOARD_SIZE], int maxExponent) {
+    std::uniform_int_distribution<int> dis(0, maxExponent);
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            int e = dis(gen);
+            cells[i][j] = e == 0 ? 0 : 1 << e;
+        }
+}
+
+}
 
 TEST_CASE("1") {
     startNewGame();
@@ -82,10 +174,9 @@ TEST_CASE("5") {
 }
 
 TEST_CASE("6") {
-    int val = 2;
     for (int i = 0; i < BOARD_SIZE; ++i)
         for (int j = 0; j < BOARD_SIZE; ++j)
-            board[i][j] = val++;
+            board[i][j] = (i + j) % 2 == 0 ? 2 : 4;
 
     CHECK(canMove() == false);
 }
@@ -109,3 +200,1280 @@ TEST_CASE("7") {
 
     CHECK(after >= before);
 }
+
+TEST_CASE("8") {
+    std::mt19937 gen(2048);
+    for (int n = 0; n < 20000; ++n) {
+        int expected[BOARD_SIZE][BOARD_SIZE];
+        randomCells(gen, expected, n % 2 == 0 ? 3 : 14);
+        Board b = packBoard(expected);
+        for (Direction dir : ALL_DIRECTIONS) {
+            int cells[BOARD_SIZE][BOARD_SIZE];
+            std::copy(&expected[0][0], &expected[0][0] + BOARD_SIZE * BOARD_SIZE, &cells[0][0]);
+            int expectedScore = 0;
+            bool expectedMoved = referenceMove(cells, directionToChar(dir), expectedScore);
+
+            int gained = 0;
+            Board next = moveBoard(b, dir, gained);
+            REQUIRE(next == packBoard(cells));
+            REQUIRE(gained == expectedScore);
+            REQUIRE((next != b) == expectedMoved);
+        }
+        REQUIRE(canMoveBoard(b) == referenceCanMove(expected));
+    }
+}
+
+TEST_CASE("9") {
+    std::mt19937 gen(4096);
+    for (int n = 0; n < 1000; ++n) {
+        int expected[BOARD_SIZE][BOARD_SIZE];
+        randomCells(gen, expected, 11);
+        std::copy(&expected[0][0], &expected[0][0] + BOARD_SIZE * BOARD_SIZE, &board[0][0]);
+        score = 0;
+        int expectedScore = 0;
+        char dir = "wasd"[n % 4];
+        bool expectedMoved = referenceMove(expected, dir, expectedScore);
+
+        CHECK(move(dir) == expectedMoved);
+        CHECK(score == expectedScore);
+        for (int i = 0; i < BOARD_SIZE; ++i)
+            for (int j = 0; j < BOARD_SIZE; ++j)
+                CHECK(board[i][j] == expected[i][j]);
+        CHECK(canMove() == referenceCanMove(expected));
+    }
+}
+
+TEST_CASE("10") {
+    Board b = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            b = withCell(b, i, j, BOARD_SIZE * i + j);
+
+    Board t = transpose(b);
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            CHECK(cellExponent(t, i, j) == cellExponent(b, j, i));
+    CHECK(transpose(t) == b);
+    CHECK(countEmpty(b) == 1);
+
+    Board capped = withCell(withCell(0, 0, 0, MAX_EXPONENT), 0, 1, MAX_EXPONENT);
+    int gained = 0;
+    CHECK(moveBoard(capped, Direction::Left, gained) == capped);
+    CHECK(gained == 0);
+
+    // Полное поле, где равны только две плитки 32768, — конец партии.
+    Board full = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            full = withCell(full, i, j, 1 + (i + j) % 2);
+    full = withCell(withCell(full, 0, 0, MAX_EXPONENT), 0, 1, MAX_EXPONENT);
+    CHECK_FALSE(canMoveBoard(full));
+    CHECK_FALSE(hasMergeablePair(full));
+    CHECK_FALSE(matchesNeighbor(full, 0));
+    for (Direction dir : ALL_DIRECTIONS)
+        CHECK(moveBoard(full, dir, gained) == full);
+    CHECK_FALSE(canMoveBoard(transpose(full)));
+    GenericBoard<3> generic;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            generic.setExponent(i, j, 1 + (i + j) % 2);
+    generic.setExponent(0, 0, GENERIC_MAX_EXPONENT);
+    generic.setExponent(0, 1, GENERIC_MAX_EXPONENT);
+    CHECK_FALSE(generic.canMove());
+
+    // Значения, которые не являются плитками, не упаковываются.
+    CHECK(isTileValue(0));
+    CHECK(isTileValue(32768));
+    CHECK_FALSE(isTileValue(1));
+    CHECK_FALSE(isTileValue(6));
+    CHECK_FALSE(isTileValue(65536));
+    CHECK_FALSE(isTileValue(-2));
+    int cells[BOARD_SIZE][BOARD_SIZE] = {{2, 0, 0, 0}, {0, 4, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 32768}};
+    REQUIRE(tryPackBoard(cells).has_value());
+    CHECK(*tryPackBoard(cells) == packBoard(cells));
+    cells[2][2] = 3;
+    CHECK_FALSE(tryPackBoard(cells).has_value());
+}
+
+TEST_CASE("11") {
+    Game first(7);
+    Game second(7);
+    first.startNew();
+    second.startNew();
+    CHECK(first.board() == second.board());
+
+    for (int n = 0; n < 200 && first.canMove(); ++n) {
+        char dir = "wasd"[n % 4];
+        bool moved = first.move(dir);
+        CHECK(second.move(dir) == moved);
+        if (moved) {
+            first.generateNumber();
+            second.generateNumber();
+        }
+        REQUIRE(first.board() == second.board());
+        REQUIRE(first.score() == second.score());
+    }
+}
+
+TEST_CASE("12") {
+    startNewGame();
+    Board before = packBoard(board);
+
+    Game other(1);
+    other.setBoard(0);
+    other.generateNumber();
+    other.move('a');
+
+    CHECK(packBoard(board) == before);
+    CHECK(score == 0);
+    CHECK(countEmpty(other.board()) == 15);
+}
+
+TEST_CASE("13") {
+    SimConfig config;
+    config.games = 64;
+    config.seed = 99;
+
+    config.threads = 1;
+    SimReport single = runSimulation(config, policyByName("random"));
+    config.threads = 4;
+    SimReport parallel = runSimulation(config, policyByName("random"));
+
+    CHECK(single.games == 64);
+    CHECK(parallel.games == 64);
+    CHECK(single.moves == parallel.moves);
+    CHECK(single.scores == parallel.scores);
+    CHECK(single.maxTileHistogram == parallel.maxTileHistogram);
+    CHECK_FALSE(policyByName("unknown"));
+}
+
+TEST_CASE("14") {
+    // Единственный ход, объединяющий плитки: влево или вправо.
+    Board b = 0;
+    b = withCell(b, 0, 0, 1);
+    b = withCell(b, 0, 1, 1);
+    for (int i = 1; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            b = withCell(b, i, j, 2 + (i + j) % 2 + 2 * i);
+    ExpectimaxSearch search(12);
+    auto dir = search.bestMove(b, {});
+    REQUIRE(dir.has_value());
+    CHECK((*dir == Direction::Left || *dir == Direction::Right));
+    CHECK(search.stats().nodes > 0);
+
+    Board stuck = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            stuck = withCell(stuck, i, j, (i + j) % 2 == 0 ? 1 : 2);
+    CHECK_FALSE(search.bestMove(stuck, {}).has_value());
+
+    Game game(3);
+    game.startNew();
+    auto timed = bestMove(game.board(), {0, std::chrono::microseconds(2000)});
+    REQUIRE(timed.has_value());
+    CHECK(game.move(*timed));
+}
+
+TEST_CASE("15") {
+    Rng first(123), second(123), third(124);
+    bool differs = false;
+    for (int n = 0; n < 100; ++n) {
+        std::uint64_t x = first.next();
+        CHECK(x == second.next());
+        differs = differs || x != third.next();
+    }
+    CHECK(differs);
+
+    std::mt19937 gen(5);
+    for (int n = 0; n < 1000; ++n) {
+        int cells[BOARD_SIZE][BOARD_SIZE];
+        randomCells(gen, cells, 2);
+        Board b = packBoard(cells);
+        int k = 0;
+        for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+            if (cellExponent(b, cell / BOARD_SIZE, cell % BOARD_SIZE) == 0)
+                REQUIRE(nthEmptyShift(b, k++) == 4 * cell);
+        REQUIRE(k == countEmpty(b));
+    }
+
+    Game game(77);
+    int fours = 0, spawns = 0;
+    for (int n = 0; n < 2000; ++n) {
+        game.setBoard(0);
+        game.generateNumber();
+        REQUIRE(countEmpty(game.board()) == 15);
+        fours += maxExponent(game.board()) == 2;
+        ++spawns;
+    }
+    CHECK(fours > spawns / 20);
+    CHECK(fours < spawns / 5);
+}
+
+TEST_CASE("16") {
+    auto dir = std::filesystem::temp_directory_path() / "2048_test_save";
+    std::filesystem::create_directories(dir);
+    std::string path = (dir / "savegame.bin").string();
+
+    Game original(11);
+    original.startNew();
+    original.move('a');
+    original.generateNumber();
+    original.setScore(36);
+    original.setBestScore(20);
+    REQUIRE(original.save(path));
+    CHECK(original.bestScore() == 36);
+    CHECK(std::filesystem::file_size(path) == SAVE_RECORD_SIZE);
+    CHECK_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    Game restored(0);
+    REQUIRE(restored.load(path));
+    CHECK(restored.board() == original.board());
+    CHECK(restored.score() == 36);
+    CHECK(restored.bestScore() == 36);
+    original.generateNumber();
+    restored.generateNumber();
+    CHECK(restored.board() == original.board());
+
+    auto bytes = encodeSaveRecord(original.snapshot());
+    SaveRecord record;
+    CHECK(decodeSaveRecord(bytes.data(), bytes.size(), record));
+    CHECK_FALSE(decodeSaveRecord(bytes.data(), bytes.size() - 1, record));
+    bytes[10] ^= 1;
+    CHECK_FALSE(decodeSaveRecord(bytes.data(), bytes.size(), record));
+    REQUIRE(writeFileAtomic(path, bytes.data(), bytes.size()));
+    CHECK_FALSE(restored.load(path));
+
+    std::string textPath = (dir / "savegame.txt").string();
+    std::string bestPath = (dir / "bestscore.txt").string();
+    {
+        std::ofstream text(textPath);
+        text << "2 0 0 0\n0 4 0 0\n0 0 8 0\n0 0 0 16\n28";
+        std::ofstream best(bestPath);
+        best << 100;
+    }
+    Game legacy(0);
+    REQUIRE(legacy.loadText(textPath, bestPath));
+    CHECK(cellValue(legacy.board(), 3, 3) == 16);
+    CHECK(legacy.score() == 28);
+    CHECK(legacy.bestScore() == 100);
+
+    // Поле с недопустимыми значениями плиток не загружается.
+    Board loaded = legacy.board();
+    for (const char* bad : {"3", "65536", "-4"}) {
+        {
+            std::ofstream text(textPath);
+            text << bad << " 0 0 0\n0 0 0 0\n0 0 0 0\n0 0 0 0\n0";
+        }
+        CHECK_FALSE(legacy.loadText(textPath, bestPath));
+        CHECK(legacy.board() == loaded);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("17") {
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_journal";
+    std::filesystem::create_directories(tmp);
+    std::string path = (tmp / "savegame.journal").string();
+
+    JournalOptions options;
+    options.batchBytes = 64;
+    options.snapshotInterval = 100;
+
+    Game game(21);
+    game.startNew();
+    int moves = 0;
+    std::vector<Board> states;
+    {
+        Journal journal(options);
+        REQUIRE(journal.open(path, game));
+        for (int n = 0; game.canMove() && moves < 250; ++n) {
+            Direction dir = ALL_DIRECTIONS[static_cast<std::size_t>(n % 4)];
+            if (!game.move(dir)) continue;
+            Board moved = game.board();
+            game.generateNumber();
+            journal.recordMove(dir, moved, game);
+            states.push_back(game.board());
+            ++moves;
+        }
+    }
+    int snapshots = 1 + moves / options.snapshotInterval;
+    CHECK(std::filesystem::file_size(path) ==
+          static_cast<std::uintmax_t>(snapshots * (1 + static_cast<int>(SAVE_RECORD_SIZE)) + moves));
+
+    Game replayed(0);
+    std::vector<JournalMove> history;
+    std::uint64_t validBytes = 0;
+    REQUIRE(Journal::replay(path, replayed, &validBytes, &history));
+    CHECK(replayed.board() == game.board());
+    CHECK(replayed.score() == game.score());
+    CHECK(static_cast<int>(history.size()) == moves);
+    CHECK(validBytes == std::filesystem::file_size(path));
+
+    Game fromLast(0);
+    REQUIRE(Journal::replay(path, fromLast));
+    CHECK(fromLast.board() == game.board());
+
+    // Обрезанный хвост: партия восстанавливается до последнего целого хода.
+    std::filesystem::resize_file(path, validBytes - 3);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.put(static_cast<char>(0x53));
+    }
+    Game truncated(0);
+    REQUIRE(Journal::replay(path, truncated, &validBytes));
+    CHECK(truncated.board() == states[static_cast<std::size_t>(moves - 4)]);
+
+    Journal resumed(options);
+    REQUIRE(resumed.resume(path, validBytes, truncated));
+    resumed.close();
+    Game again(0);
+    REQUIRE(Journal::replay(path, again));
+    CHECK(again.board() == truncated.board());
+
+    // saveGame() сбрасывает ходы журнала на диск, не дожидаясь закрытия.
+    auto cwd = std::filesystem::current_path();
+    std::filesystem::current_path(tmp);
+    setJournalMode(true);
+    startNewGame();
+    for (char key : {'a', 'w', 'd', 's', 'a', 'w'})
+        if (move(key)) generateNumber();
+    saveGame();
+    Game flushed(0);
+    REQUIRE(Journal::replay("savegame.journal", flushed));
+    CHECK(flushed.board() == packBoard(board));
+    CHECK(flushed.score() == score);
+    setJournalMode(false);
+    std::filesystem::current_path(cwd);
+
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("18") {
+    for (int r = 0; r < 65536; ++r) {
+        std::array<std::uint8_t, 4> line{};
+        for (std::size_t k = 0; k < 4; ++k)
+            line[k] = static_cast<std::uint8_t>((r >> (4 * k)) & 0xF);
+        // Плитки 32768 в упакованном поле не объединяются.
+        if (std::find(line.begin(), line.end(), MAX_EXPONENT) != line.end()) continue;
+        int points = 0;
+        slideLine<4>(line, points);
+        int packed = 0;
+        for (std::size_t k = 0; k < 4; ++k)
+            packed |= line[k] << (4 * k);
+        REQUIRE(packed == rowTables.left[static_cast<std::size_t>(r)]);
+        REQUIRE(points == rowTables.score[static_cast<std::size_t>(r)]);
+    }
+
+    static_assert([] {
+        GenericBoard<3> b;
+        b.setExponent(0, 2, 1);
+        b.setExponent(2, 2, 1);
+        int points = 0;
+        return b.move(Direction::Down, points) && b.exponent(2, 2) == 2 && points == 4;
+    }());
+
+    GenericBoard<5> b;
+    b.setExponent(1, 0, 3);
+    b.setExponent(1, 4, 3);
+    b.setExponent(1, 2, 2);
+    int points = 0;
+    CHECK(b.move(Direction::Right, points));
+    CHECK(b.exponent(1, 4) == 3);
+    CHECK(b.exponent(1, 3) == 2);
+    CHECK(b.exponent(1, 2) == 3);
+    CHECK(points == 0);
+    CHECK_FALSE(b.move(Direction::Right, points));
+
+    GenericBoard<4> packed;
+    Game game(8);
+    Rng rng(8);
+    packed.spawn(rng);
+    packed.spawn(rng);
+    game.startNew();
+    CHECK(packed.packed() == game.board());
+}
+
+TEST_CASE("19") {
+    auto play = [](auto b) {
+        Rng rng(3);
+        b.spawn(rng);
+        int points = 0, moves = 0;
+        while (b.canMove() && moves < 100000) {
+            bool moved = false;
+            for (Direction dir : ALL_DIRECTIONS)
+                if (b.move(dir, points)) {
+                    moved = true;
+                    break;
+                }
+            REQUIRE(moved);
+            b.spawn(rng);
+            ++moves;
+        }
+        return moves;
+    };
+    CHECK(play(GenericBoard<3>{}) > 0);
+    CHECK(play(GenericBoard<6>{}) > play(GenericBoard<3>{}));
+    CHECK(play(GenericBoard<8>{}) > 0);
+}
+
+TEST_CASE("20") {
+    std::mt19937 gen(10);
+    const std::size_t n = 1003;
+    std::vector<Board> boards(n);
+    for (Board& b : boards) {
+        int cells[BOARD_SIZE][BOARD_SIZE];
+        randomCells(gen, cells, 6);
+        b = packBoard(cells);
+    }
+
+    for (BatchKernel kernel : {BatchKernel::Scalar, BatchKernel::Avx2}) {
+        if (!batchKernelSupported(kernel)) continue;
+        for (Direction dir : ALL_DIRECTIONS) {
+            std::vector<Board> next(n);
+            std::vector<int> scores(n);
+            std::unique_ptr<bool[]> moved(new bool[n]);
+            moveBatchWith(kernel, dir, boards.data(), n, next.data(), scores.data(), moved.get());
+            for (std::size_t i = 0; i < n; ++i) {
+                int gained = 0;
+                Board expected = moveBoard(boards[i], dir, gained);
+                REQUIRE(next[i] == expected);
+                REQUIRE(scores[i] == gained);
+                REQUIRE(moved[i] == (expected != boards[i]));
+            }
+        }
+    }
+    CHECK(batchKernelSupported(activeBatchKernel()));
+}
+
+TEST_CASE("21") {
+    std::mt19937 gen(21);
+    for (int k = 0; k < 16; ++k)
+        CHECK(nthSetBit(emptyMask(0), k) == 4 * k);
+
+    for (int trial = 0; trial < 200; ++trial) {
+        Game game(static_cast<std::uint64_t>(trial));
+        game.startNew();
+        if (trial % 2 == 1) {
+            int cells[BOARD_SIZE][BOARD_SIZE];
+            randomCells(gen, cells, 3);
+            game.setBoard(packBoard(cells));
+        }
+        while (true) {
+            REQUIRE(game.emptyCells() == emptyMask(game.board()));
+            REQUIRE(game.canMove() == canMoveBoard(game.board()));
+            if (!game.canMove()) break;
+            Direction dir = ALL_DIRECTIONS[gen() % 4];
+            if (game.move(dir)) game.generateNumber();
+        }
+    }
+}
+
+TEST_CASE("22") {
+    Game game(22);
+    game.startNew();
+    for (int step = 0; step < 5; ++step) {
+        MonteCarloSearch single(1);
+        auto expected = single.bestMove(game.board(), 20, 99);
+        REQUIRE(expected.has_value());
+        int unused = 0;
+        CHECK(moveBoard(game.board(), *expected, unused) != game.board());
+        for (unsigned threads : {2u, 3u, 8u}) {
+            MonteCarloSearch search(threads);
+            CHECK(search.bestMove(game.board(), 20, 99) == expected);
+            CHECK(search.stats().moves == single.stats().moves);
+            CHECK(search.stats().meanGain == single.stats().meanGain);
+            // Повторный вызов на том же пуле даёт тот же результат.
+            CHECK(search.bestMove(game.board(), 20, 99) == expected);
+        }
+        game.move(*expected);
+        game.generateNumber();
+    }
+
+    MonteCarloSearch search(2);
+    CHECK_FALSE(search.bestMove(0x1212212112122121ULL, 10, 1).has_value());
+    CHECK(search.stats().playouts == 0);
+    CHECK(policyByName("montecarlo"));
+}
+
+TEST_CASE("23") {
+    profileReset();
+    startNewGame();
+    moveLeft();
+    moveUp();
+    canMove();
+    {
+        const ProfileScope scope(ProfilePoint::PrintBoard);
+    }
+    SimReport report = runSimulation({4, 2, 3, {}}, policyByName("random"));
+
+    ProfileSnapshot snapshot = profileSnapshot();
+    auto calls = [&](ProfilePoint p) { return snapshot[static_cast<std::size_t>(p)].calls; };
+    CHECK(calls(ProfilePoint::PrintBoard) == 1);
+    if constexpr (PROFILE_ENABLED) {
+        CHECK(calls(ProfilePoint::MoveLeft) == 1);
+        CHECK(calls(ProfilePoint::MoveUp) == 1);
+        CHECK(calls(ProfilePoint::CanMove) == 1);
+        // Счётчики завершившихся потоков симуляции тоже учтены.
+        CHECK(calls(ProfilePoint::Move) == 2 + report.moves);
+        CHECK(calls(ProfilePoint::GenerateNumber) >= 2 + 2 * report.games + report.moves);
+    } else {
+        CHECK(calls(ProfilePoint::Move) == 0);
+        CHECK(calls(ProfilePoint::GenerateNumber) == 0);
+    }
+    CHECK(std::string(profilePointName(ProfilePoint::GenerateNumber)) == "generateNumber");
+
+    // Таблица не меняет формат чисел в потоке вызывающего.
+    std::ostringstream table;
+    printProfile(table);
+    CHECK(table.str().find("printBoard") != std::string::npos);
+    table.str("");
+    table << 2.25 << ' ' << 1e6 / 3;
+    CHECK(table.str() == "2.25 333333");
+
+    profileReset();
+    CHECK(profileSnapshot()[static_cast<std::size_t>(ProfilePoint::PrintBoard)].calls == 0);
+}
+
+TEST_CASE("24") {
+    TerminalRenderer renderer;
+    Board b = withCell(withCell(0, 0, 0, 1), 3, 3, 11);
+    std::string first(renderer.frame(b, 4, 100));
+    CHECK(first == "\x1b[H\x1b[2JScore: 4  Best: 100\n\n"
+                   "    2    0    0    0\n\n"
+                   "    0    0    0    0\n\n"
+                   "    0    0    0    0\n\n"
+                   "    0    0    0 2048\n\n\x1b[J");
+
+    // Без изменений — только курсор под полем.
+    CHECK(renderer.frame(b, 4, 100) == "\x1b[11;1H\x1b[J");
+
+    Board next = withCell(withCell(b, 0, 0, 0), 1, 2, 2);
+    CHECK(renderer.frame(next, 8, 100) ==
+          "\x1b[1;1HScore: 8  Best: 100\x1b[K\x1b[3;1H    0\x1b[5;11H    4\x1b[11;1H\x1b[J");
+
+    renderer.invalidate();
+    CHECK(renderer.frame(next, 8, 100).substr(0, 7) == "\x1b[H\x1b[2J");
+}
+
+TEST_CASE("25") {
+    KeyDecoder decoder;
+    std::string keys;
+    decoder.feed("W a\n\x1b[A\x1bOB", 10, keys);
+    CHECK(keys == "waws");
+    // Последовательность, разорванная между чтениями, и параметры модификаторов.
+    keys.clear();
+    decoder.feed("\x1b", 1, keys);
+    decoder.feed("[1;5", 4, keys);
+    decoder.feed("Dq\x03", 3, keys);
+    CHECK(keys == "aqq");
+
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    const std::string script = "1 dd\x1b[C\nq";
+    REQUIRE(::write(fds[1], script.data(), script.size()) ==
+            static_cast<ssize_t>(script.size()));
+    ::close(fds[1]);
+    {
+        KeyReader reader(fds[0]);
+        CHECK_FALSE(reader.interactive());
+        std::string batch;
+        CHECK(reader.readBatch(batch));
+        CHECK(batch == "1dddq");
+        CHECK(reader.lastReadCycles() != 0);
+        CHECK_FALSE(reader.readBatch(batch));
+    }
+    ::close(fds[0]);
+}
+
+TEST_CASE("26") {
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_book";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    std::string first = (tmp / "first.book").string();
+    std::string second = (tmp / "second.book").string();
+    std::string merged = (tmp / "merged.book").string();
+
+    Game game(26);
+    game.startNew();
+    Board start = game.board();
+    std::vector<BookEntry> entries = {
+        {0x30, 5.0f, static_cast<std::uint8_t>(Direction::Left), 2, 0},
+        {start, 7.0f, static_cast<std::uint8_t>(Direction::Down), 3, 0},
+        {0x30, 6.0f, static_cast<std::uint8_t>(Direction::Right), 4, 0},
+    };
+    REQUIRE(writeBook(first, entries));
+    std::vector<BookEntry> more = {{0x10, 1.0f, 0, 1, 0}, {start, 9.0f, 0, 2, 0}};
+    REQUIRE(writeBook(second, more));
+    REQUIRE(mergeBooks(merged, {first, second}));
+
+    OpeningBook book;
+    REQUIRE(book.open(merged));
+    CHECK(book.size() == 3);
+    // Из повторяющихся позиций остаётся самая глубокая.
+    auto entry = book.find(0x30);
+    REQUIRE(entry.has_value());
+    CHECK(entry->depth == 4);
+    CHECK(entry->move == static_cast<std::uint8_t>(Direction::Right));
+    CHECK(book.find(start)->depth == 3);
+    CHECK_FALSE(book.find(0x20).has_value());
+
+    ExpectimaxSearch search;
+    search.setBook(&book);
+    CHECK(search.bestMove(start, {3, {}, 0}) == Direction::Down);
+    CHECK(search.stats().bookHit);
+    CHECK(search.stats().value == 7.0f);
+    // Записи меньшей глубины, чем требуется, не используются.
+    search.bestMove(start, {4, {}, 0});
+    CHECK_FALSE(search.stats().bookHit);
+    book.close();
+
+    // Повреждённый заголовок и обрезанный файл не открываются.
+    std::filesystem::copy_file(merged, tmp / "bad.book");
+    {
+        std::fstream f(tmp / "bad.book", std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(10);
+        f.put(static_cast<char>(BOARD_ENCODING + 1));
+    }
+    CHECK_FALSE(book.open((tmp / "bad.book").string()));
+    std::filesystem::resize_file(merged, std::filesystem::file_size(merged) - 1);
+    CHECK_FALSE(book.open(merged));
+
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("27") {
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_record";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    std::string path = (tmp / "games.rec").string();
+
+    SimReport report = runSimulation({40, 3, 27, path}, policyByName("random"));
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+    std::vector<RecordBlock> blocks;
+    REQUIRE(readRecordIndex(fd, blocks));
+    std::vector<unsigned char> data;
+    std::vector<GameRecord> games;
+    std::vector<int> scores;
+    std::uint64_t moves = 0;
+    for (const RecordBlock& block : blocks) {
+        data.resize(block.size);
+        REQUIRE(::pread(fd, data.data(), block.size, static_cast<off_t>(block.offset)) ==
+                static_cast<ssize_t>(block.size));
+        REQUIRE(decodeRecordBlock(data.data(), block, games));
+        for (const GameRecord& record : games) {
+            // Повторная игра по зерну и ходам даёт записанные приросты счёта.
+            Game game(record.seed);
+            game.startNew();
+            for (std::size_t k = 0; k < record.moves.size(); ++k) {
+                int before = game.score();
+                REQUIRE(game.move(record.moves[k]));
+                game.generateNumber();
+                REQUIRE(game.score() - before == record.scoreDeltas[k]);
+            }
+            CHECK_FALSE(game.canMove());
+            scores.push_back(game.score());
+            moves += record.moves.size();
+        }
+    }
+    std::sort(scores.begin(), scores.end());
+    CHECK(scores == report.scores);
+    CHECK(moves == report.moves);
+
+    // Испорченные данные блока обнаруживаются по контрольной сумме.
+    REQUIRE(!blocks.empty());
+    data.resize(blocks[0].size);
+    REQUIRE(::pread(fd, data.data(), blocks[0].size, static_cast<off_t>(blocks[0].offset)) > 0);
+    data[data.size() / 2] ^= 0x40;
+    CHECK_FALSE(decodeRecordBlock(data.data(), blocks[0], games));
+    data[data.size() / 2] ^= 0x40;
+
+    // Число партий в заголовке не может превышать размер данных.
+    RecordBlock huge = blocks[0];
+    huge.games = 0xFFFFFFFFu;
+    games.clear();
+    CHECK_FALSE(decodeRecordBlock(data.data(), huge, games));
+    CHECK(games.empty());
+    ::close(fd);
+
+    // Оборванный последний блок отбрасывается.
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    fd = ::open(path.c_str(), O_RDONLY);
+    std::vector<RecordBlock> truncated;
+    REQUIRE(readRecordIndex(fd, truncated));
+    CHECK(truncated.size() == blocks.size() - 1);
+    ::close(fd);
+
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("28") {
+    Arena arena(64);
+    auto* byte = arena.allocate<std::uint8_t>(1);
+    REQUIRE(byte != nullptr);
+    Arena::Marker marker = arena.mark();
+    Board* boards = arena.allocate<Board>(4);
+    REQUIRE(boards != nullptr);
+    CHECK(reinterpret_cast<std::uintptr_t>(boards) % alignof(Board) == 0);
+    CHECK(arena.stats().used == 40);
+    CHECK(arena.allocate<Board>(4) == nullptr);
+    CHECK(arena.stats().failures == 1);
+    arena.release(marker);
+    CHECK(arena.stats().used == 1);
+    CHECK(arena.allocate<Board>(4) != nullptr);
+    CHECK(arena.stats().peak == 40);
+    arena.reset();
+    CHECK(arena.stats().used == 0);
+    CHECK(arena.stats().peak == 0);
+    CHECK(arena.stats().allocations == 3);
+    CHECK(arena.stats().resets == 1);
+    arena.reserve(32);
+    CHECK(arena.stats().capacity == 64);
+    arena.reserve(128);
+    CHECK(arena.stats().capacity == 128);
+    CHECK(arena.allocate<Board>(16) != nullptr);
+
+    // Поиск возвращает арену пустой, а пик ограничен глубиной поиска.
+    Game game(11);
+    game.startNew();
+    for (int k = 0; k < 20; ++k) {
+        game.move(static_cast<Direction>(k % 4));
+        game.generateNumber();
+    }
+    ExpectimaxSearch search(12);
+    ExpectimaxSearch roomy(12, std::size_t{1} << 20);
+    SearchBudget budget;
+    budget.depth = 2;
+    auto dir = search.bestMove(game.board(), budget);
+    REQUIRE(dir.has_value());
+    CHECK(dir == roomy.bestMove(game.board(), budget));
+    CHECK(search.stats().value == roomy.stats().value);
+    CHECK(search.arenaStats().used == 0);
+    CHECK(search.arenaStats().peak > 0);
+    CHECK(search.arenaStats().peak <= 4 * 16 * sizeof(Board));
+    CHECK(search.arenaStats().failures == 0);
+    CHECK(search.arenaStats().resets == 1);
+    CHECK(search.stats().arenaFallbacks == 0);
+
+    // Маленькая арена растёт до нужной глубине, и ход не меняется.
+    ExpectimaxSearch tiny(12, 64);
+    budget.depth = 3;
+    auto deep = roomy.bestMove(game.board(), budget);
+    CHECK(tiny.bestMove(game.board(), budget) == deep);
+    CHECK(tiny.stats().value == roomy.stats().value);
+    CHECK(tiny.arenaStats().capacity > 64);
+    CHECK(tiny.arenaStats().failures == 0);
+    CHECK(tiny.stats().arenaFallbacks == 0);
+}
+
+TEST_CASE("29") {
+    // Табличная оценка с весами по умолчанию совпадает с поклеточным расчётом.
+    auto cellByCell = [](Board b) {
+        float gradient = 0.0f;
+        int pairs = 0;
+        for (int i = 0; i < BOARD_SIZE; ++i)
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                int cell = cellExponent(b, i, j);
+                gradient += static_cast<float>(cell * (2 * BOARD_SIZE - 2 - i - j));
+                if (cell == 0) continue;
+                if (j + 1 < BOARD_SIZE && cellExponent(b, i, j + 1) == cell) ++pairs;
+                if (i + 1 < BOARD_SIZE && cellExponent(b, i + 1, j) == cell) ++pairs;
+            }
+        return 1000.0f + 270.0f * static_cast<float>(countEmpty(b)) +
+               700.0f * static_cast<float>(pairs) + 10.0f * gradient;
+    };
+    Rng rng(29);
+    for (int k = 0; k < 1000; ++k) {
+        Board b = rng.next() & rng.next();
+        CHECK(evaluateBoard(b) == cellByCell(b));
+    }
+
+    // Признаки линии по отдельности.
+    auto only = [](float EvalWeights::*weight) {
+        EvalWeights w{};
+        w.base = 0.0f;
+        w.empty = 0.0f;
+        w.pairs = 0.0f;
+        w.gradient = 0.0f;
+        w.*weight = 1.0f;
+        return BoardEvaluator(w);
+    };
+    // Линия 2, 0, 2, 4 (показатели 1, 0, 1, 2), первая ячейка — младшие биты.
+    const std::uint16_t line = 0x2101;
+    CHECK(only(&EvalWeights::empty).line(line) == 0.5f);
+    CHECK(only(&EvalWeights::pairs).line(line) == 0.0f);
+    CHECK(only(&EvalWeights::merges).line(line) == 1.0f);
+    CHECK(only(&EvalWeights::gradient).line(line) == 4.0f);
+    CHECK(only(&EvalWeights::corner).line(line) == 3.0f);
+    CHECK(only(&EvalWeights::monotonicity).line(line) == -1.0f);
+    CHECK(only(&EvalWeights::smoothness).line(line) == -1.0f);
+    CHECK(only(&EvalWeights::monotonicity).line(0x4321) == 0.0f);
+
+    // Оценка не бывает отрицательной, веса перестраиваются на ходу.
+    BoardEvaluator evaluator = only(&EvalWeights::smoothness);
+    CHECK(evaluator.evaluate(0x0000000000001F01ULL) == 0.0f);
+    EvalWeights weights = evaluator.weights();
+    weights.base = 100.0f;
+    evaluator.setWeights(weights);
+    CHECK(evaluator.evaluate(0x0000000000001F01ULL) == 100.0f - 14.0f - 14.0f);
+
+    EvalWeights parsed;
+    REQUIRE(parseEvalWeights("smoothness=5,corner=-1.5", parsed));
+    CHECK(parsed.smoothness == 5.0f);
+    CHECK(parsed.corner == -1.5f);
+    CHECK(parsed.empty == 270.0f);
+    CHECK_FALSE(parseEvalWeights("unknown=1", parsed));
+    CHECK_FALSE(parseEvalWeights("empty=abc", parsed));
+    CHECK_FALSE(parseEvalWeights("empty", parsed));
+
+    // Поиск с другим оценщиком находит ход.
+    ExpectimaxSearch search(12);
+    search.setEvaluator(&evaluator);
+    Game game(5);
+    game.startNew();
+    CHECK(search.bestMove(game.board(), {}).has_value());
+}
+
+TEST_CASE("30") {
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_ntuple";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    std::string path = (tmp / "small.ntuple").string();
+
+    NTupleNetwork network;
+    CHECK_FALSE(network.create({{0, 1, 16}}));
+    CHECK_FALSE(network.create(ntuplePatterns("unknown")));
+    REQUIRE(network.create(ntuplePatterns("small")));
+    CHECK(network.features() == 5 * 8);
+
+    Game game(30);
+    game.startNew();
+    for (int k = 0; k < 30 && game.canMove(); ++k) {
+        game.move(static_cast<Direction>(k % 4));
+        game.generateNumber();
+    }
+    Board b = game.board();
+    CHECK(network.evaluate(b) == 0.0f);
+    network.update(b, 1.0f);
+    CHECK(network.evaluate(b) >= 40.0f);
+
+    // Шаблоны применяются во всех симметриях, поэтому оценка симметрична.
+    Board mirrored = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i)
+        for (int j = 0; j < BOARD_SIZE; ++j)
+            mirrored = withCell(mirrored, i, BOARD_SIZE - 1 - j, cellExponent(b, i, j));
+    CHECK(network.evaluate(transpose(b)) == network.evaluate(b));
+    CHECK(network.evaluate(mirrored) == network.evaluate(b));
+
+    // Файл весов отображается обратно без разбора.
+    REQUIRE(network.save(path));
+    NTupleNetwork loaded;
+    REQUIRE(loaded.open(path));
+    CHECK(loaded.patterns() == network.patterns());
+    CHECK(loaded.evaluate(b) == network.evaluate(b));
+    CHECK(loaded.bestMove(b) == network.bestMove(b));
+    loaded.close();
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    CHECK_FALSE(loaded.open(path));
+
+    // Обучение в несколько потоков: все партии сыграны и учтены.
+    TrainConfig config;
+    config.threads = 2;
+    config.games = 40;
+    NTupleNetwork parallel;
+    REQUIRE(parallel.create(ntuplePatterns("small")));
+    {
+        NTupleTrainer trainer(parallel, config);
+        trainer.wait();
+        CHECK(trainer.finished());
+        TrainProgress progress = trainer.progress();
+        CHECK(progress.games == 40);
+        CHECK(progress.moves > 40);
+        CHECK(progress.maxScore > 0);
+        CHECK(progress.scoreSum >= progress.maxScore);
+    }
+    CHECK(parallel.evaluate(b) != 0.0f);
+
+    // В один поток обучение детерминировано: одно зерно — одни веса,
+    // и обученная сеть играет лучше случайной.
+    config.threads = 1;
+    config.games = 300;
+    NTupleNetwork trained, again;
+    REQUIRE(trained.create(ntuplePatterns("small")));
+    REQUIRE(again.create(ntuplePatterns("small")));
+    for (NTupleNetwork* target : {&trained, &again}) {
+        NTupleTrainer trainer(*target, config);
+        trainer.wait();
+        CHECK(trainer.progress().games == 300);
+    }
+    CHECK(trained.evaluate(b) == again.evaluate(b));
+    CHECK(trained.evaluate(transpose(b)) == again.evaluate(transpose(b)));
+    REQUIRE(trained.save(path));
+    REQUIRE(loaded.open(path));
+    SimReport learned =
+        runSimulation({50, 1, 7, {}}, policyByName("ntuple", {}, nullptr, nullptr, &loaded));
+    SimReport random = runSimulation({50, 1, 7, {}}, policyByName("random"));
+    CHECK(learned.scores[25] > 2 * random.scores[25]);
+    CHECK_FALSE(policyByName("ntuple"));
+
+    loaded.close();
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("31") {
+    // Сокет лежит в каталоге теста, поэтому одновременные запуски
+    // не должны делить каталог.
+    auto tmp = std::filesystem::temp_directory_path() /
+               ("2048_test_server_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    ServerConfig config;
+    config.socketPath = (tmp / "s.sock").string();
+    config.loops = 2;
+    config.storePath = (tmp / "sessions.bin").string();
+    config.saveInterval = std::chrono::milliseconds(10);
+
+    auto connectClient = [&] {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, config.socketPath.c_str(), config.socketPath.size() + 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+        return fd;
+    };
+    auto exchange = [](int fd, const std::vector<unsigned char>& request, std::size_t responses) {
+        REQUIRE(::write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+        std::vector<unsigned char> data(responses * RESPONSE_SIZE);
+        std::size_t got = 0;
+        while (got < data.size()) {
+            ssize_t n = ::read(fd, data.data() + got, data.size() - got);
+            if (n <= 0) break;
+            got += static_cast<std::size_t>(n);
+        }
+        std::vector<ServerResponse> result;
+        for (std::size_t k = 0; k + RESPONSE_SIZE <= got; k += RESPONSE_SIZE)
+            result.push_back(decodeResponse(data.data() + k));
+        return result;
+    };
+
+    auto server = std::make_unique<GameServer>(config);
+    REQUIRE(server->start());
+    CHECK(server->loops() == 2);
+
+    // Ход до начала партии.
+    int fd = connectClient();
+    std::vector<unsigned char> request;
+    encodeMoveRequest(Direction::Left, request);
+    auto responses = exchange(fd, request, 1);
+    REQUIRE(responses.size() == 1);
+    CHECK(responses[0].status == RESPONSE_NO_GAME);
+
+    // Новая партия и пачка ходов совпадают с локальной партией.
+    Game local(31);
+    local.startNew();
+    request.clear();
+    encodeNewRequest(31, request);
+    for (int k = 0; k < 20; ++k) encodeMoveRequest(static_cast<Direction>(k % 4), request);
+    responses = exchange(fd, request, 21);
+    REQUIRE(responses.size() == 21);
+    CHECK(responses[0].status == RESPONSE_OK);
+    CHECK(responses[0].board == local.board());
+    std::uint64_t id = responses[0].game;
+    CHECK(id != 0);
+    for (int k = 0; k < 20; ++k) {
+        bool moved = local.move(static_cast<Direction>(k % 4));
+        if (moved) local.generateNumber();
+        CHECK(responses[static_cast<std::size_t>(k) + 1].board == local.board());
+        CHECK(responses[static_cast<std::size_t>(k) + 1].score == local.score());
+        CHECK(((responses[static_cast<std::size_t>(k) + 1].flags & RESPONSE_MOVED) != 0) == moved);
+        CHECK(responses[static_cast<std::size_t>(k) + 1].game == id);
+    }
+    ::close(fd);
+
+    // После отключения партию можно продолжить с другого соединения.
+    request.clear();
+    encodeResumeRequest(id + 100, request);
+    encodeResumeRequest(id, request);
+    fd = connectClient();
+    bool resumed = false;
+    for (int attempt = 0; attempt < 100 && !resumed; ++attempt) {
+        responses = exchange(fd, request, 2);
+        REQUIRE(responses.size() == 2);
+        CHECK(responses[0].status == RESPONSE_UNKNOWN_GAME);
+        resumed = responses[1].status == RESPONSE_OK;
+        if (!resumed) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(resumed);
+    CHECK(responses[1].board == local.board());
+    CHECK(responses[1].game == id);
+    ::close(fd);
+
+    // Перезапуск: партия читается из файла.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server->stats().active != 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(server->stats().active == 0);
+    server->stop();
+    CHECK(std::filesystem::exists(config.storePath));
+    server = std::make_unique<GameServer>(config);
+    REQUIRE(server->start());
+    fd = connectClient();
+    request.clear();
+    encodeResumeRequest(id, request);
+    encodeMoveRequest(Direction::Down, request);
+    responses = exchange(fd, request, 2);
+    REQUIRE(responses.size() == 2);
+    CHECK(responses[0].status == RESPONSE_OK);
+    CHECK(responses[0].board == local.board());
+    if (local.move(Direction::Down)) local.generateNumber();
+    CHECK(responses[1].board == local.board());
+
+    // Неизвестная операция закрывает соединение.
+    request.assign(1, 0x7f);
+    responses = exchange(fd, request, 2);
+    REQUIRE(responses.size() == 1);
+    CHECK(responses[0].status == RESPONSE_BAD_REQUEST);
+    ::close(fd);
+
+    // Клиент закрыл свою сторону, не дочитав ответы: сервер дописывает
+    // очередь и закрывает соединение, читая EOF ровно один раз.
+    // Размеры перебираются, чтобы остаток очереди после заполнения буфера
+    // сокета оказался меньше OUTPUT_LIMIT при любом разумном буфере.
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server->stats().active != 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::uint64_t hangups = server->stats().hangups;
+    int halfClosed = 0;
+    for (int moves = 6000; moves <= 16000; moves += 1000, ++halfClosed) {
+        fd = connectClient();
+        request.clear();
+        encodeNewRequest(31, request);
+        for (int k = 0; k < moves; ++k) encodeMoveRequest(Direction::Left, request);
+        REQUIRE(::write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+        REQUIRE(::shutdown(fd, SHUT_WR) == 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        std::size_t received = 0;
+        unsigned char chunk[16384];
+        for (ssize_t n; (n = ::read(fd, chunk, sizeof(chunk))) > 0;)
+            received += static_cast<std::size_t>(n);
+        ::close(fd);
+        CHECK(received == static_cast<std::size_t>(moves + 1) * RESPONSE_SIZE);
+        CHECK(server->stats().hangups == hangups + static_cast<std::uint64_t>(halfClosed) + 1);
+    }
+    CHECK(server->stats().connections == static_cast<std::uint64_t>(1 + halfClosed));
+
+    server->stop();
+    CHECK_FALSE(std::filesystem::exists(config.socketPath));
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("32") {
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_history";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    std::string path = (tmp / "savegame.bin").string();
+
+    Game game(32);
+    game.startNew();
+    History history(4);
+    CHECK_FALSE(history.undo(game));
+    std::vector<HistoryEntry> states{History::capture(game)};
+    for (int k = 0; states.size() < 7; ++k) {
+        HistoryEntry before = History::capture(game);
+        if (!game.move(static_cast<Direction>(k % 4))) continue;
+        history.record(before);
+        game.generateNumber();
+        states.push_back(History::capture(game));
+    }
+
+    // Глубина 4: помнятся только четыре последних хода.
+    CHECK(history.position() == 4);
+    for (std::size_t k = 6; k-- > 2;) {
+        REQUIRE(history.undo(game));
+        CHECK(game.board() == states[k].board);
+        CHECK(game.score() == states[k].score);
+    }
+    CHECK_FALSE(history.undo(game));
+    REQUIRE(history.redo(game));
+    REQUIRE(history.redo(game));
+    CHECK(game.board() == states[4].board);
+
+    // Генератор восстановлен: тот же ход даёт то же число.
+    Game copy = game;
+    REQUIRE(history.redo(game));
+    REQUIRE(history.undo(game));
+    CHECK(game.rng().state() == copy.rng().state());
+
+    // Переход к любому снимку и обратно.
+    REQUIRE(history.seek(0, game));
+    CHECK(game.board() == states[2].board);
+    REQUIRE(history.seek(history.size() - 1, game));
+    CHECK(game.board() == states[6].board);
+    CHECK_FALSE(history.redo(game));
+    CHECK_FALSE(history.seek(history.size(), game));
+
+    // Сохранение вместе с историей; без истории читается только запись.
+    REQUIRE(history.seek(2, game));
+    REQUIRE(game.save(path, &history));
+    CHECK(std::filesystem::file_size(path) > SAVE_RECORD_SIZE);
+    Game loaded(0);
+    History restored(4);
+    REQUIRE(loaded.load(path, &restored));
+    CHECK(loaded.board() == states[4].board);
+    CHECK(restored.position() == 2);
+    CHECK(restored.size() == history.size());
+    REQUIRE(restored.redo(loaded));
+    CHECK(loaded.board() == states[5].board);
+    Game plain(0);
+    REQUIRE(plain.load(path));
+    CHECK(plain.board() == states[4].board);
+
+    // Меньший буфер сохраняет самые новые снимки.
+    History small(1);
+    REQUIRE(loaded.load(path, &small));
+    CHECK(small.position() == 1);
+    REQUIRE(small.undo(loaded));
+    CHECK(loaded.board() == states[3].board);
+
+    // Новый ход после отмены отбрасывает повтор.
+    REQUIRE(restored.undo(loaded));
+    HistoryEntry before = History::capture(loaded);
+    for (Direction dir : ALL_DIRECTIONS)
+        if (loaded.move(dir)) break;
+    restored.record(before);
+    CHECK_FALSE(restored.canRedo());
+
+    // Повреждённый блок истории не мешает загрузке партии.
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    REQUIRE(loaded.load(path, &restored));
+    CHECK(restored.size() == 0);
+    CHECK_FALSE(restored.undo(loaded));
+
+    std::filesystem::remove_all(tmp);
+}
+
+TEST_CASE("33") {
+    // Симметрии согласованы с ходами, ячейками и каноническим полем.
+    Rng rng(33);
+    for (int trial = 0; trial < 200; ++trial) {
+        Board b = 0;
+        for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+            if (rng.below(3) != 0) b |= static_cast<Board>(rng.below(12)) << (4 * cell);
+        CanonicalBoard key = canonicalBoard(b);
+        CHECK(key.board == applySymmetry(b, key.symmetry));
+        for (int symmetry = 0; symmetry < SYMMETRY_COUNT; ++symmetry) {
+            Board s = applySymmetry(b, symmetry);
+            CHECK(key.board <= s);
+            CHECK(canonicalBoard(s).board == key.board);
+            for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+                CHECK(((s >> (4 * symmetryCell(cell, symmetry))) & 0xF) ==
+                      ((b >> (4 * cell)) & 0xF));
+            for (Direction dir : ALL_DIRECTIONS) {
+                int points = 0;
+                int mapped = 0;
+                Direction t = symmetryDirection(dir, symmetry);
+                CHECK(applySymmetry(moveBoard(b, dir, points), symmetry) ==
+                      moveBoard(s, t, mapped));
+                CHECK(points == mapped);
+                CHECK(inverseSymmetryDirection(t, symmetry) == dir);
+            }
+        }
+    }
+    CHECK(mirrorLeftRight(0x4321) == 0x1234);
+    CHECK(mirrorUpDown(0x1) == Board{1} << 48);
+
+    // Канонические ключи таблицы — только для симметричной оценки.
+    CHECK_FALSE(defaultEvaluator().symmetric());
+    EvalWeights weights;
+    weights.gradient = 0.0f;
+    BoardEvaluator symmetric(weights);
+    CHECK(symmetric.symmetric());
+    ExpectimaxSearch raw;
+    raw.setEvaluator(&symmetric);
+    raw.setCanonicalKeys(false);
+    ExpectimaxSearch canonical;
+    CHECK_FALSE(canonical.canonicalKeys());
+    canonical.setEvaluator(&symmetric);
+    CHECK(canonical.canonicalKeys());
+
+    Game game(33);
+    game.startNew();
+    std::uint64_t rawHits = 0;
+    std::uint64_t canonicalHits = 0;
+    for (int k = 0; k < 40 && game.canMove(); ++k) {
+        auto expected = raw.bestMove(game.board(), {3, {}, 0});
+        auto found = canonical.bestMove(game.board(), {3, {}, 0});
+        REQUIRE(expected.has_value());
+        REQUIRE(found.has_value());
+        // Значения совпадают с точностью до порядка сложения.
+        CHECK(canonical.stats().value == doctest::Approx(raw.stats().value).epsilon(1e-4));
+        rawHits += raw.stats().cacheHits;
+        canonicalHits += canonical.stats().cacheHits;
+        game.move(*expected);
+        game.generateNumber();
+    }
+    CHECK(canonicalHits > rawHits);
+
+    // Каноническая книга: одна запись на все симметричные позиции.
+    auto tmp = std::filesystem::temp_directory_path() / "2048_test_symmetry";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+    std::string path = (tmp / "canonical.book").string();
+    Board start = withCell(withCell(0, 0, 1, 1), 2, 3, 2);
+    std::vector<BookEntry> entries;
+    for (int symmetry = 0; symmetry < SYMMETRY_COUNT; ++symmetry)
+        entries.push_back({applySymmetry(start, symmetry), 5.0f,
+                           static_cast<std::uint8_t>(symmetryDirection(Direction::Left, symmetry)),
+                           3, 0});
+    REQUIRE(writeBook(path, entries, true));
+    OpeningBook book;
+    REQUIRE(book.open(path));
+    CHECK(book.canonical());
+    CHECK(book.size() == 1);
+    for (int symmetry = 0; symmetry < SYMMETRY_COUNT; ++symmetry) {
+        Board b = applySymmetry(start, symmetry);
+        auto entry = book.find(b);
+        REQUIRE(entry.has_value());
+        CHECK(entry->board == b);
+        CHECK(entry->move ==
+              static_cast<std::uint8_t>(symmetryDirection(Direction::Left, symmetry)));
+    }
+    book.close();
+    std::string merged = (tmp / "merged.book").string();
+    REQUIRE(mergeBooks(merged, {path}));
+    REQUIRE(book.open(merged));
+    CHECK(book.canonical());
+    CHECK(book.size() == 1);
+    book.close();
+
+    // Ход из канонической книги совпадает со свежим поиском на отражённой
+    // позиции; при несимметричной оценке такая книга не используется.
+    Board position = game.board();
+    REQUIRE(canMoveBoard(position));
+    auto searched = raw.bestMove(position, {3, {}, 0});
+    REQUIRE(searched.has_value());
+    std::vector<BookEntry> positions{
+        {position, raw.stats().value, static_cast<std::uint8_t>(*searched), 3, 0}};
+    std::string searchedPath = (tmp / "searched.book").string();
+    REQUIRE(writeBook(searchedPath, positions, true));
+    REQUIRE(book.open(searchedPath));
+    ExpectimaxSearch booked;
+    booked.setEvaluator(&symmetric);
+    booked.setBook(&book);
+    for (int symmetry = 0; symmetry < SYMMETRY_COUNT; ++symmetry) {
+        Board mirrored = applySymmetry(position, symmetry);
+        auto fromBook = booked.bestMove(mirrored, {3, {}, 0});
+        CHECK(booked.stats().bookHit);
+        auto fresh = raw.bestMove(mirrored, {3, {}, 0});
+        CHECK(fromBook == fresh);
+        CHECK(booked.stats().value == doctest::Approx(raw.stats().value).epsilon(1e-4));
+    }
+    ExpectimaxSearch asymmetric;
+    asymmetric.setBook(&book);
+    CHECK(asymmetric.bestMove(applySymmetry(position, 1), {3, {}, 0}).has_value());
+    CHECK_FALSE(asymmetric.stats().bookHit);
+    book.close();
+    std::filesystem::remove_all(tmp);
+}
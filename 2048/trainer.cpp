@@ -0,0 +1,97 @@
+/**
+ * @file trainer.cpp
+ * @brief Реализация обучения сети n-кортежей.
+ *
+ * Содержит определение функций, объявленных в trainer.h.
+ */
+
+#include "trainer.h"
+
+#include <algorithm>
+
+#include "game.h"
+#include "simulator.h"
+
+NTupleTrainer::NTupleTrainer(NTupleNetwork& network, const TrainConfig& config)
+    : network_(network), config_(config) {
+    unsigned threads = config_.threads != 0 ? config_.threads
+                                            : std::max(1u, std::thread::hardware_concurrency());
+    counters_ = std::vector<Counters>(threads);
+    active_.store(threads, std::memory_order_relaxed);
+    for (unsigned t = 0; t < threads; ++t)
+        pool_.emplace_back([this, t](std::stop_token stop) { worker(stop, t); });
+}
+
+NTupleTrainer::~NTupleTrainer() {
+    stop();
+}
+
+void NTupleTrainer::stop() {
+    for (std::jthread& thread : pool_) thread.request_stop();
+    wait();
+}
+
+void NTupleTrainer::wait() {
+    for (std::jthread& thread : pool_)
+        if (thread.joinable()) thread.join();
+}
+
+TrainProgress NTupleTrainer::progress() const {
+    TrainProgress total;
+    for (const Counters& c : counters_) {
+        total.games += c.games.load(std::memory_order_relaxed);
+        total.moves += c.moves.load(std::memory_order_relaxed);
+        total.scoreSum += c.scoreSum.load(std::memory_order_relaxed);
+        total.maxScore = std::max(total.maxScore, c.maxScore.load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+void NTupleTrainer::worker(std::stop_token stop, unsigned self) {
+    Counters& counters = counters_[self];
+    float rate = config_.learningRate / static_cast<float>(network_.features());
+    float lambda = config_.lambda;
+    std::vector<Board> afterstates;
+    std::vector<int> rewards;
+
+    while (!stop.stop_requested()) {
+        std::uint64_t index = nextGame_.fetch_add(1, std::memory_order_relaxed);
+        if (config_.games != 0 && index >= config_.games) break;
+
+        Game game(gameSeed(config_.seed, index));
+        game.startNew();
+        afterstates.clear();
+        rewards.clear();
+        while (game.canMove()) {
+            Direction dir = network_.bestMove(game.board()).value_or(Direction::Up);
+            int before = game.score();
+            game.move(dir);
+            afterstates.push_back(game.board());
+            rewards.push_back(game.score() - before);
+            game.generateNumber();
+        }
+
+        // λ-возврат от последнего хода к первому; после последнего хода
+        // партия окончена, и его цель — 0.
+        float nextReturn = 0.0f;
+        float nextValue = 0.0f;
+        for (std::size_t t = afterstates.size(); t-- > 0;) {
+            float target = 0.0f;
+            if (t + 1 < afterstates.size())
+                target = static_cast<float>(rewards[t + 1]) + (1.0f - lambda) * nextValue +
+                         lambda * nextReturn;
+            float value = network_.evaluate(afterstates[t]);
+            network_.update(afterstates[t], rate * (target - value));
+            nextReturn = target;
+            nextValue = value;
+        }
+
+        auto score = static_cast<std::uint64_t>(game.score());
+        counters.games.fetch_add(1, std::memory_order_relaxed);
+        counters.moves.fetch_add(afterstates.size(), std::memory_order_relaxed);
+        counters.scoreSum.fetch_add(score, std::memory_order_relaxed);
+        if (score > counters.maxScore.load(std::memory_order_relaxed))
+            counters.maxScore.store(score, std::memory_order_relaxed);
+    }
+    active_.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file trainer.h
+ * @brief Обучение сети n-кортежей (см. ntuple.h) методом TD на игре с собой.
+ *
+ * Обучается оценка состояния после хода (afterstate): поля после
+ * move(), но до generateNumber(). Ход выбирается жадно по очкам хода
+ * плюс оценке поля после него (NTupleNetwork::bestMove()), партия
+ * играется по правилам Game::move() и Game::generateNumber().
+ *
+ * После партии оценки полей после ходов s'_t обновляются от конца к
+ * началу к λ-возврату
+ * G_t = r_{t+1} + (1 - λ) V(s'_{t+1}) + λ G_{t+1}, G_T = 0,
+ * где r_{t+1} — очки следующего хода. При λ = 0 это цель TD(0):
+ * r_{t+1} + V(s'_{t+1}).
+ *
+ * Потоки играют свои партии и обновляют общие веса без блокировок
+ * (Hogwild, см. NTupleNetwork). Счётчики каждого потока лежат в своей
+ * строке кэша; progress() складывает их, не останавливая обучение.
+ */
+
+#ifndef GAME_2048_TRAINER_H
+#define GAME_2048_TRAINER_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ntuple.h"
+
+/**
+ * @brief Параметры обучения.
+ */
+struct TrainConfig {
+    unsigned threads = 0;           ///< Количество потоков (0 — std::thread::hardware_concurrency()).
+    std::uint64_t games = 0;        ///< Сколько партий сыграть (0 — до stop()).
+    std::uint64_t seed = 1;         ///< Базовое зерно; партия k играется с gameSeed(seed, k).
+    float learningRate = 0.1f;      ///< Шаг на поле; делится поровну между признаками.
+    float lambda = 0.0f;            ///< λ для λ-возврата (0 — TD(0)).
+};
+
+/**
+ * @brief Итоги обучения на момент вызова progress().
+ */
+struct TrainProgress {
+    std::uint64_t games = 0;        ///< Сыграно партий.
+    std::uint64_t moves = 0;        ///< Сделано ходов.
+    std::uint64_t scoreSum = 0;     ///< Сумма счетов партий.
+    std::uint64_t maxScore = 0;     ///< Лучший счёт.
+};
+
+/**
+ * @brief Пул потоков обучения.
+ *
+ * @code
+ * NTupleNetwork network;
+ * network.create(ntuplePatterns("small"));
+ * NTupleTrainer trainer(network, {});
+ * // ... periodically: trainer.progress(), network.save(path)
+ * trainer.stop();
+ * @endcode
+ */
+class NTupleTrainer {
+public:
+    /**
+     * @brief Запускает потоки обучения.
+     * @param network Сеть с изменяемыми весами; должна жить дольше тренера.
+     * @param config Параметры обучения.
+     */
+    NTupleTrainer(NTupleNetwork& network, const TrainConfig& config);
+
+    /** @brief Останавливает потоки и ждёт их завершения. */
+    ~NTupleTrainer();
+
+    NTupleTrainer(const NTupleTrainer&) = delete;
+    NTupleTrainer& operator=(const NTupleTrainer&) = delete;
+
+    /**
+     * @brief Просит потоки остановиться после текущей партии и ждёт их.
+     * @return void
+     */
+    void stop();
+
+    /**
+     * @brief Ждёт, пока потоки сыграют config.games партий.
+     * @return void
+     *
+     * Не просит потоки остановиться, поэтому при config.games == 0 не вернётся.
+     */
+    void wait();
+
+    /**
+     * @brief Завершено ли обучение (сыграно config.games партий или вызван stop()).
+     * @return bool true, если все потоки вышли.
+     */
+    bool finished() const { return active_.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * @brief Сумма счётчиков всех потоков.
+     * @return TrainProgress итоги на данный момент.
+     */
+    TrainProgress progress() const;
+
+    /**
+     * @brief Число потоков.
+     * @return unsigned количество потоков обучения.
+     */
+    unsigned threads() const { return static_cast<unsigned>(pool_.size()); }
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> games{0};
+        std::atomic<std::uint64_t> moves{0};
+        std::atomic<std::uint64_t> scoreSum{0};
+        std::atomic<std::uint64_t> maxScore{0};
+    };
+
+    void worker(std::stop_token stop, unsigned self);
+
+    NTupleNetwork& network_;
+    TrainConfig config_;
+    std::atomic<std::uint64_t> nextGame_{0};
+    std::atomic<unsigned> active_{0};
+    std::vector<Counters> counters_;
+    std::vector<std::jthread> pool_;
+};
+
+#endif
@@ -6,20 +6,44 @@
  */
 
 #include "2048.h"
+#include "input.h"
+#include "ntuple.h"
+#include "profile.h"
 #include <iostream>
-#include <ctime>
-#include <cctype>
+#include <cstring>
+#include <string>
 
-int main() {
-    srand(static_cast<unsigned>(time(0)));
+namespace {
 
-    char choice;
+bool isMoveKey(char key) {
+    return key == 'w' || key == 'a' || key == 's' || key == 'd';
+}
+
+}
+
+int main(int argc, char** argv) {
+    // С --weights FILE клавиша H делает ход обученной сети (см. ntuple.h).
+    NTupleNetwork network;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--journal") == 0) {
+            setJournalMode(true);
+        } else if (std::strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            if (!network.open(argv[++i])) std::cerr << "Cannot open weights: " << argv[i] << '\n';
+        }
+    }
+
+    // Клавиши читаются пачками без Enter; из канала — как сценарий ходов:
+    // echo "1 wasdwasd q" | 2048_game
+    KeyReader input;
+    std::string keys;
+    std::size_t next = 0;
 
     std::cout << "====== 2048 GAME ======\n";
     std::cout << "1. Continue saved game\n";
     std::cout << "2. Start new game\n";
-    std::cout << "Choose (1 or 2): ";
-    std::cin >> choice;
+    std::cout << "Choose (1 or 2): " << std::flush;
+    while (keys.empty() && input.readBatch(keys)) {}
+    char choice = keys.empty() ? 'q' : keys[next++];
 
     bool loaded = false;
 
@@ -33,32 +57,67 @@ int main() {
         startNewGame();
     }
 
-    while (true) {
-        printBoard();
+    bool redraw = true;
+    bool quit = false;
+    while (!quit) {
+        if (redraw) {
+            printBoard();
+            // Задержка от поступления клавиш до кадра с их результатом.
+            if (PROFILE_ENABLED && input.lastReadCycles() != 0)
+                profileRecord(ProfilePoint::InputToFrame, cycleCount() - input.lastReadCycles());
+            redraw = false;
 
-        if (!canMove()) {
-            std::cout << "Game Over! No more possible moves.\n";
-            break;
+            if (!canMove()) {
+                std::cout << "Game Over! No more possible moves.\n";
+                break;
+            }
+            std::cout << "Move (WASD or arrows, U/R to undo/redo"
+                      << (network.isOpen() ? ", H for a hint move" : "") << ", Q to quit): "
+                      << std::flush;
         }
 
-        std::cout << "Move (WASD, Q to quit): ";
-        char moveChar;
-        std::cin >> moveChar;
-        moveChar = static_cast<char>(std::tolower(moveChar));
-
-        if (moveChar == 'q') break;
+        if (next >= keys.size()) {
+            keys.clear();
+            next = 0;
+            if (!input.readBatch(keys)) break;
+        }
 
-        if (moveChar != 'w' && moveChar != 'a' && moveChar != 's' && moveChar != 'd') {
-            std::cout << "Invalid input! Use WASD keys to move.\n";
-            continue;
+        // Все накопившиеся клавиши применяются до одной перерисовки.
+        bool moved = false;
+        bool invalid = false;
+        for (; next < keys.size() && !quit; ++next) {
+            char key = keys[next];
+            if (key == 'h' && network.isOpen())
+                if (std::optional<Direction> hint = network.bestMove(defaultGame().board()))
+                    key = directionToChar(*hint);
+            if (key == 'q') {
+                quit = true;
+            } else if (PROFILE_ENABLED && key == 'p') {
+                std::cout << '\n';
+                printProfile(std::cout);
+            } else if (key == 'u' || key == 'r') {
+                if (key == 'u' ? undoMove() : redoMove()) moved = true;
+            } else if (!isMoveKey(key)) {
+                invalid = true;
+            } else if (move(key)) {
+                generateNumber();
+                moved = true;
+                if (!canMove()) {
+                    next = keys.size();
+                    break;
+                }
+            }
         }
 
-        if (move(moveChar)) {
-            generateNumber();
+        if (moved) {
             saveGame();
+            redraw = true;
+        } else if (invalid && !quit) {
+            std::cout << "\nInvalid input! Use WASD or arrow keys to move." << std::flush;
         }
     }
 
     saveGame();
+    if (PROFILE_ENABLED) printProfile(std::cerr);
     return 0;
 }
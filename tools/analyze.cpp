@@ -0,0 +1,247 @@
+/**
+ * @file analyze.cpp
+ * @brief Сводная статистика по файлу записей партий (см. record.h).
+ *
+ * Использование:
+ * @code
+ * 2048_sim --games 1000000 --record games.rec
+ * 2048_analyze games.rec                 # файл отображается в память
+ * 2048_analyze games.rec --stream        # блоки читаются pread() по порядку
+ * 2048_analyze games.rec --threads 8 --no-replay
+ * @endcode
+ *
+ * Блоки делятся между потоками; каждый поток ведёт свою статистику,
+ * объединение — один раз в конце. Счёт по ходам берётся из записанных
+ * приростов. Старшая плитка требует повторной игры (Game::move() и
+ * Game::generateNumber()), которая заодно проверяет, что записанные
+ * приросты совпадают с правилами игры; --no-replay её отключает.
+ */
+
+#include "game.h"
+#include "record.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Номера ходов, в которых снимаются средний счёт и средняя старшая плитка.
+const std::array<std::uint64_t, 8> CHECKPOINTS = {10, 100, 250, 500, 1000, 2000, 5000, 10000};
+
+struct alignas(64) Stats {
+    std::uint64_t games = 0;
+    std::uint64_t moves = 0;
+    std::uint64_t badBlocks = 0;
+    std::uint64_t mismatches = 0;
+    std::array<std::uint64_t, 4> directions{};
+    std::array<std::uint64_t, 16> maxTileHistogram{};
+    std::array<std::uint64_t, CHECKPOINTS.size()> reached{};
+    std::array<double, CHECKPOINTS.size()> scoreSum{};
+    std::array<double, CHECKPOINTS.size()> exponentSum{};
+    std::vector<int> scores;
+
+    void merge(const Stats& other) {
+        games += other.games;
+        moves += other.moves;
+        badBlocks += other.badBlocks;
+        mismatches += other.mismatches;
+        for (std::size_t k = 0; k < directions.size(); ++k) directions[k] += other.directions[k];
+        for (std::size_t k = 0; k < maxTileHistogram.size(); ++k)
+            maxTileHistogram[k] += other.maxTileHistogram[k];
+        for (std::size_t k = 0; k < CHECKPOINTS.size(); ++k) {
+            reached[k] += other.reached[k];
+            scoreSum[k] += other.scoreSum[k];
+            exponentSum[k] += other.exponentSum[k];
+        }
+        scores.insert(scores.end(), other.scores.begin(), other.scores.end());
+    }
+};
+
+void analyzeGame(const GameRecord& record, bool replay, Stats& stats) {
+    Game game(record.seed);
+    if (replay) game.startNew();
+
+    int score = 0;
+    std::size_t checkpoint = 0;
+    for (std::size_t k = 0; k < record.moves.size(); ++k) {
+        Direction dir = record.moves[k];
+        score += record.scoreDeltas[k];
+        ++stats.directions[static_cast<std::size_t>(dir)];
+        if (replay) {
+            game.move(dir);
+            game.generateNumber();
+        }
+        if (checkpoint < CHECKPOINTS.size() && k + 1 == CHECKPOINTS[checkpoint]) {
+            ++stats.reached[checkpoint];
+            stats.scoreSum[checkpoint] += score;
+            stats.exponentSum[checkpoint] += maxExponent(game.board());
+            ++checkpoint;
+        }
+    }
+    ++stats.games;
+    stats.moves += record.moves.size();
+    stats.scores.push_back(score);
+    if (replay) {
+        if (game.score() != score) ++stats.mismatches;
+        ++stats.maxTileHistogram[static_cast<std::size_t>(maxExponent(game.board()))];
+    }
+}
+
+void printUsage() {
+    std::cerr << "Usage: 2048_analyze FILE [--threads T] [--stream] [--no-replay]\n";
+}
+
+int percentile(const std::vector<int>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))];
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string path = argv[1];
+    unsigned threads = 0;
+    bool stream = false;
+    bool replay = true;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (std::strcmp(argv[i], "--no-replay") == 0) {
+            replay = false;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    std::vector<RecordBlock> blocks;
+    if (fd < 0 || !readRecordIndex(fd, blocks)) {
+        std::cerr << "Not a game record file (or another version): " << path << '\n';
+        return 1;
+    }
+
+    const unsigned char* mapped = nullptr;
+    std::size_t mappedSize = 0;
+    if (!stream) {
+        struct stat info {};
+        ::fstat(fd, &info);
+        mappedSize = static_cast<std::size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "mmap failed, falling back to --stream\n";
+            stream = true;
+        } else {
+            ::madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+            mapped = static_cast<const unsigned char*>(mapping);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> nextBlock{0};
+    std::vector<Stats> stats(threads);
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                std::vector<unsigned char> buffer;
+                std::vector<GameRecord> games;
+                while (true) {
+                    std::size_t index = nextBlock.fetch_add(1, std::memory_order_relaxed);
+                    if (index >= blocks.size()) return;
+                    const RecordBlock& block = blocks[index];
+                    const unsigned char* data = mapped ? mapped + block.offset : nullptr;
+                    if (data == nullptr) {
+                        buffer.resize(block.size);
+                        if (::pread(fd, buffer.data(), block.size,
+                                    static_cast<off_t>(block.offset)) !=
+                            static_cast<ssize_t>(block.size)) {
+                            ++stats[t].badBlocks;
+                            continue;
+                        }
+                        data = buffer.data();
+                    }
+                    if (!decodeRecordBlock(data, block, games)) {
+                        ++stats[t].badBlocks;
+                        continue;
+                    }
+                    for (const GameRecord& game : games)
+                        analyzeGame(game, replay, stats[t]);
+                }
+            });
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Stats total;
+    for (const Stats& s : stats) total.merge(s);
+    std::sort(total.scores.begin(), total.scores.end());
+    if (mapped) ::munmap(const_cast<unsigned char*>(mapped), mappedSize);
+    ::close(fd);
+
+    double games = static_cast<double>(std::max<std::uint64_t>(total.games, 1));
+    double moves = static_cast<double>(std::max<std::uint64_t>(total.moves, 1));
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "blocks:      " << blocks.size() << " (" << total.badBlocks << " bad)\n";
+    std::cout << "games:       " << total.games << '\n';
+    std::cout << "moves:       " << total.moves << '\n';
+    std::cout << "threads:     " << threads << (stream ? " (stream)" : " (mmap)") << '\n';
+    std::cout << "time:        " << seconds << " s\n";
+    std::cout << "moves/sec:   " << static_cast<double>(total.moves) / std::max(seconds, 1e-9)
+              << '\n';
+    if (replay) std::cout << "mismatches:  " << total.mismatches << '\n';
+
+    std::cout << "\nscore: min " << percentile(total.scores, 0.0)
+              << "  p50 " << percentile(total.scores, 0.5)
+              << "  p90 " << percentile(total.scores, 0.9)
+              << "  max " << percentile(total.scores, 1.0) << '\n';
+
+    static const char* const names[] = {"up", "left", "down", "right"};
+    std::cout << "\ndirections:\n";
+    for (std::size_t k = 0; k < total.directions.size(); ++k)
+        std::cout << std::setw(8) << names[k] << "  " << std::setw(6)
+                  << 100.0 * static_cast<double>(total.directions[k]) / moves << "%\n";
+
+    std::cout << "\n    move     games   mean score" << (replay ? "   max tile (geo mean)" : "") << '\n';
+    for (std::size_t k = 0; k < CHECKPOINTS.size(); ++k) {
+        if (total.reached[k] == 0) continue;
+        double reached = static_cast<double>(total.reached[k]);
+        std::cout << std::setw(8) << CHECKPOINTS[k] << std::setw(10) << total.reached[k]
+                  << std::setw(13) << total.scoreSum[k] / reached;
+        if (replay) std::cout << std::setw(22) << std::exp2(total.exponentSum[k] / reached);
+        std::cout << '\n';
+    }
+
+    if (replay) {
+        std::cout << "\nmax tile:\n";
+        for (std::size_t e = 1; e < total.maxTileHistogram.size(); ++e) {
+            std::uint64_t count = total.maxTileHistogram[e];
+            if (count == 0) continue;
+            std::cout << std::setw(8) << (1 << e) << "  " << std::setw(10) << count << "  "
+                      << std::setw(6) << 100.0 * static_cast<double>(count) / games << "%\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,524 @@
+/**
+ * @file bench.cpp
+ * @brief Микробенчмарки ходов, оценки полей, генерации чисел, сохранения,
+ *        вывода кадров, полных партий и выбора хода Монте-Карло.
+ *
+ * Каждый бенчмарк выполняется с удвоением числа итераций, пока время
+ * не превысит --min-time. Наборы полей строятся из партий с
+ * фиксированными зёрнами, поэтому результаты сравнимы между коммитами.
+ *
+ * Использование:
+ * @code
+ * 2048_bench                       # таблица
+ * 2048_bench --json > bench.json   # JSON в формате Google Benchmark
+ * 2048_bench --filter moveBoard --min-time 0.5
+ * @endcode
+ */
+
+#include "2048.h"
+#include "ai.h"
+#include "batch.h"
+#include "book.h"
+#include "eval.h"
+#include "generic_board.h"
+#include "history.h"
+#include "render.h"
+#include "rollout.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Результаты складываются сюда, чтобы компилятор не выбросил измеряемый код.
+volatile std::uint64_t sink = 0;
+
+// Дополнительная величина бенчмарка (доля попаданий, число записей).
+struct Counter {
+    std::string name;
+    double value = 0.0;
+};
+
+struct Benchmark {
+    std::string name;
+    // Выполняет n итераций и возвращает контрольную сумму.
+    std::function<std::uint64_t(std::uint64_t n)> run;
+    // Сколько элементов (ходов, полей) обрабатывает одна итерация.
+    double itemsPerOp = 1.0;
+    // Величины после последнего запуска run; необязательно.
+    std::function<std::vector<Counter>()> counters = nullptr;
+};
+
+struct BenchResult {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double itemsPerSecond = 0.0;
+    std::vector<Counter> counters;
+};
+
+const std::size_t CORPUS_SIZE = 1024;
+
+// Поля из партий случайной стратегии / жадной стратегии с фиксированными зёрнами.
+// sparse — не меньше 10 пустых ячеек, dense — не больше 4,
+// late — последние ходы жадных партий со старшей плиткой от 256.
+std::vector<Board> buildCorpus(const std::string& kind) {
+    std::vector<Board> corpus;
+    RandomPolicy random;
+    GreedyPolicy greedy;
+    Policy& policy = kind == "late" ? static_cast<Policy&>(greedy) : random;
+
+    for (std::uint64_t seed = 1; corpus.size() < CORPUS_SIZE; ++seed) {
+        Game game(seed);
+        policy.newGame(seed);
+        game.startNew();
+        std::vector<Board> history;
+        while (game.canMove()) {
+            history.push_back(game.board());
+            game.move(policy.chooseMove(game));
+            game.generateNumber();
+        }
+        for (std::size_t k = 0; k < history.size() && corpus.size() < CORPUS_SIZE; ++k) {
+            Board b = history[k];
+            int empty = countEmpty(b);
+            bool take = kind == "sparse" ? empty >= 10
+                      : kind == "dense"  ? empty <= 4
+                      : maxExponent(b) >= 8 && k + 20 >= history.size();
+            if (take) corpus.push_back(b);
+        }
+    }
+    return corpus;
+}
+
+BenchResult measure(const Benchmark& bench, double minTime) {
+    BenchResult result;
+    result.name = bench.name;
+    for (std::uint64_t n = 1;; n *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        sink = sink ^ bench.run(n);
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds >= minTime || n >= (std::uint64_t{1} << 40)) {
+            result.iterations = n;
+            result.nsPerOp = seconds * 1e9 / static_cast<double>(n);
+            result.itemsPerSecond = static_cast<double>(n) * bench.itemsPerOp / seconds;
+            if (bench.counters) result.counters = bench.counters();
+            return result;
+        }
+    }
+}
+
+// Ходы по кругу на полях NxN из случайных партий с фиксированным зерном.
+template <int N>
+void registerGenericMove(std::vector<Benchmark>& benches) {
+    auto corpus = std::make_shared<std::vector<GenericBoard<N>>>();
+    Rng rng(N);
+    while (corpus->size() < CORPUS_SIZE) {
+        GenericBoard<N> b;
+        b.spawn(rng);
+        int points = 0;
+        while (b.canMove() && corpus->size() < CORPUS_SIZE) {
+            corpus->push_back(b);
+            b.move(ALL_DIRECTIONS[rng.below(4)], points);
+            b.spawn(rng);
+        }
+    }
+    std::string name = "genericMove/" + std::to_string(N) + "x" + std::to_string(N);
+    benches.push_back({name, [corpus](std::uint64_t n) {
+        std::uint64_t sum = 0;
+        int points = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            GenericBoard<N> b = (*corpus)[i % CORPUS_SIZE];
+            sum += b.move(ALL_DIRECTIONS[i % 4], points);
+        }
+        return sum + static_cast<std::uint64_t>(points);
+    }});
+}
+
+std::vector<Benchmark> registerBenchmarks() {
+    std::vector<Benchmark> benches;
+
+    for (const char* kind : {"sparse", "dense", "late"}) {
+        auto corpus = std::make_shared<std::vector<Board>>(buildCorpus(kind));
+        std::string suffix = std::string("/") + kind;
+
+        for (Direction dir : ALL_DIRECTIONS) {
+            static const char* const names[] = {"up", "left", "down", "right"};
+            std::string dirName = names[static_cast<int>(dir)];
+            benches.push_back({"moveBoard/" + dirName + suffix, [corpus, dir](std::uint64_t n) {
+                std::uint64_t sum = 0;
+                int points = 0;
+                for (std::uint64_t i = 0; i < n; ++i)
+                    sum += moveBoard((*corpus)[i % CORPUS_SIZE], dir, points);
+                return sum + static_cast<std::uint64_t>(points);
+            }});
+        }
+
+        static const std::pair<const char*, bool (*)()> legacyMoves[] = {
+            {"moveLeft", moveLeft}, {"moveRight", moveRight},
+            {"moveUp", moveUp}, {"moveDown", moveDown}};
+        for (const auto& [name, fn] : legacyMoves) {
+            bool (*moveFn)() = fn;
+            benches.push_back({std::string(name) + suffix, [corpus, moveFn](std::uint64_t n) {
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    unpackBoard((*corpus)[i % CORPUS_SIZE], board);
+                    sum += moveFn();
+                }
+                return sum;
+            }});
+        }
+
+        for (BatchKernel kernel : {BatchKernel::Scalar, BatchKernel::Avx2}) {
+            if (!batchKernelSupported(kernel)) continue;
+            std::string name = std::string("moveBatch/") + batchKernelName(kernel) + suffix;
+            // Одна итерация — ход во всех четырёх направлениях для всего набора.
+            benches.push_back({name, [corpus, kernel](std::uint64_t n) {
+                std::vector<Board> out(CORPUS_SIZE);
+                std::vector<int> scores(CORPUS_SIZE);
+                std::unique_ptr<bool[]> moved(new bool[CORPUS_SIZE]);
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    Direction dir = ALL_DIRECTIONS[i % 4];
+                    moveBatchWith(kernel, dir, corpus->data(), CORPUS_SIZE, out.data(),
+                                  scores.data(), moved.get());
+                    sum += out[i % CORPUS_SIZE];
+                }
+                return sum;
+            }, static_cast<double>(CORPUS_SIZE)});
+        }
+
+        benches.push_back({"canMove" + suffix, [corpus](std::uint64_t n) {
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i)
+                sum += canMoveBoard((*corpus)[i % CORPUS_SIZE]);
+            return sum;
+        }});
+
+        benches.push_back({"evaluate" + suffix, [corpus](std::uint64_t n) {
+            const BoardEvaluator& evaluator = defaultEvaluator();
+            float sum = 0.0f;
+            for (std::uint64_t i = 0; i < n; ++i)
+                sum += evaluator.evaluate((*corpus)[i % CORPUS_SIZE]);
+            return static_cast<std::uint64_t>(sum);
+        }});
+
+        benches.push_back({"canonicalBoard" + suffix, [corpus](std::uint64_t n) {
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i)
+                sum += canonicalBoard((*corpus)[i % CORPUS_SIZE]).board;
+            return sum;
+        }});
+
+        benches.push_back({"generateNumber" + suffix, [corpus](std::uint64_t n) {
+            Game game(1);
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                game.setBoard((*corpus)[i % CORPUS_SIZE]);
+                game.generateNumber();
+                sum += game.board();
+            }
+            return sum;
+        }});
+    }
+
+    registerGenericMove<3>(benches);
+    registerGenericMove<4>(benches);
+    registerGenericMove<5>(benches);
+    registerGenericMove<8>(benches);
+
+    auto dir = std::filesystem::temp_directory_path() / "2048_bench";
+    std::filesystem::create_directories(dir);
+    std::string savePath = (dir / "savegame.bin").string();
+
+    benches.push_back({"saveGame", [savePath](std::uint64_t n) {
+        Game game(1);
+        game.startNew();
+        for (std::uint64_t i = 0; i < n; ++i) {
+            game.setScore(static_cast<int>(i));
+            game.save(savePath);
+        }
+        return game.board();
+    }});
+
+    benches.push_back({"loadGame", [savePath](std::uint64_t n) {
+        Game game(1);
+        game.startNew();
+        game.save(savePath);
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            game.load(savePath);
+            sum += game.board();
+        }
+        return sum;
+    }});
+
+    benches.push_back({"history/record", [](std::uint64_t n) {
+        Game game(1);
+        game.startNew();
+        History history;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            game.setScore(static_cast<int>(i));
+            history.record(History::capture(game));
+        }
+        return history.position();
+    }});
+
+    benches.push_back({"history/undo+redo", [](std::uint64_t n) {
+        Game game(1);
+        game.startNew();
+        History history;
+        for (std::size_t i = 0; i < history.depth(); ++i) {
+            game.setScore(static_cast<int>(i));
+            history.record(History::capture(game));
+        }
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            history.undo(game);
+            sum += static_cast<std::uint64_t>(game.score());
+            history.redo(game);
+        }
+        return sum;
+    }});
+
+    // Поиск в книге дебютов: первые 10 позиций 8192 случайных партий;
+    // попадания — первые CORPUS_SIZE из них. canonical — та же книга с
+    // записями под каноническими полями; entries — записей в книге.
+    {
+        std::vector<BookEntry> entries;
+        auto hits = std::make_shared<std::vector<Board>>();
+        RandomPolicy random;
+        for (std::uint64_t seed = 1; seed <= 8192; ++seed) {
+            Game game(seed);
+            random.newGame(seed);
+            game.startNew();
+            for (int k = 0; k < 10 && game.canMove(); ++k) {
+                entries.push_back({game.board(), 1.0f, 0, 3, 0});
+                if (hits->size() < CORPUS_SIZE) hits->push_back(game.board());
+                game.move(random.chooseMove(game));
+                game.generateNumber();
+            }
+        }
+        for (bool canonical : {false, true}) {
+            std::vector<BookEntry> copy = entries;
+            std::string bookPath = (dir / (canonical ? "canonical.book" : "bench.book")).string();
+            auto book = std::make_shared<OpeningBook>();
+            if (!writeBook(bookPath, copy, canonical) || !book->open(bookPath)) continue;
+            benches.push_back({canonical ? "book/find:canonical" : "book/find",
+                               [book, hits](std::uint64_t n) {
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i)
+                    sum += book->find((*hits)[i % CORPUS_SIZE]).has_value();
+                return sum;
+            }, 1.0, [book] {
+                return std::vector<Counter>{{"entries", static_cast<double>(book->size())}};
+            }});
+        }
+    }
+
+    // Поиск expectimax глубины 3 по позициям одной партии с таблицей
+    // транспозиций из 2^16 записей, общей для всех ходов партии; после
+    // последней позиции таблица очищается. Оценка без несимметричного
+    // признака gradient, чтобы канонические ключи включились; raw — те же
+    // поиски с ключами по самому полю. hit_rate — доля попаданий в
+    // таблицу, nodes — узлов на поиск.
+    {
+        auto positions = std::make_shared<std::vector<Board>>();
+        Game game(5);
+        GreedyPolicy greedy;
+        game.startNew();
+        while (game.canMove() && positions->size() < 256) {
+            positions->push_back(game.board());
+            game.move(greedy.chooseMove(game));
+            game.generateNumber();
+        }
+        EvalWeights weights;
+        weights.gradient = 0.0f;
+        auto evaluator = std::make_shared<BoardEvaluator>(weights);
+        for (bool canonical : {false, true}) {
+            struct SearchRun {
+                ExpectimaxSearch search{16};
+                std::uint64_t probes = 0;
+                std::uint64_t hits = 0;
+                std::uint64_t nodes = 0;
+                std::uint64_t searches = 0;
+            };
+            auto last = std::make_shared<std::unique_ptr<SearchRun>>();
+            benches.push_back({canonical ? "expectimax/keys:canonical" : "expectimax/keys:raw",
+                               [positions, evaluator, canonical, last](std::uint64_t n) {
+                auto run = std::make_unique<SearchRun>();
+                run->search.setEvaluator(evaluator.get());
+                run->search.setCanonicalKeys(canonical);
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    std::size_t k = i % positions->size();
+                    auto best = run->search.bestMove((*positions)[k], {3, {}, 0});
+                    sum += best ? static_cast<std::uint64_t>(*best) : 4;
+                    run->probes += run->search.stats().cacheProbes;
+                    run->hits += run->search.stats().cacheHits;
+                    run->nodes += run->search.stats().nodes;
+                    ++run->searches;
+                    if (k + 1 == positions->size()) run->search.clear();
+                }
+                *last = std::move(run);
+                return sum;
+            }, 1.0, [last] {
+                const SearchRun& run = **last;
+                double probes = static_cast<double>(std::max<std::uint64_t>(run.probes, 1));
+                return std::vector<Counter>{
+                    {"hit_rate", static_cast<double>(run.hits) / probes},
+                    {"nodes", static_cast<double>(run.nodes) /
+                                  static_cast<double>(std::max<std::uint64_t>(run.searches, 1))}};
+            }});
+        }
+    }
+
+    // Ходов в средней случайной партии — для перевода в ходы/сек.
+    double movesPerGame = 0.0;
+    {
+        RandomPolicy policy;
+        std::uint64_t moves = 0;
+        for (std::uint64_t seed = 0; seed < 256; ++seed)
+            moves += playGame(policy, gameSeed(7, seed)).moves;
+        movesPerGame = static_cast<double>(moves) / 256.0;
+    }
+    benches.push_back({"playout/random", [](std::uint64_t n) {
+        RandomPolicy policy;
+        std::uint64_t sum = 0;
+        for (std::uint64_t i = 0; i < n; ++i)
+            sum += playGame(policy, gameSeed(7, i % 256)).moves;
+        return sum;
+    }, movesPerGame});
+
+    // Кадры printBoard() для последовательных позиций одной партии:
+    // full — каждый кадр заново, diff — только изменившиеся ячейки.
+    auto frames = std::make_shared<std::vector<Board>>();
+    {
+        Game game(11);
+        RandomPolicy policy;
+        policy.newGame(11);
+        game.startNew();
+        while (game.canMove() && game.move(policy.chooseMove(game))) {
+            game.generateNumber();
+            frames->push_back(game.board());
+        }
+    }
+    for (bool full : {true, false}) {
+        benches.push_back({full ? "render/full" : "render/diff", [frames, full](std::uint64_t n) {
+            TerminalRenderer renderer;
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                if (full) renderer.invalidate();
+                sum += renderer.frame((*frames)[i % frames->size()], static_cast<int>(i), 0).size();
+            }
+            return sum;
+        }});
+    }
+
+    // Выбор хода Монте-Карло: одна итерация — bestMove() с ROLLOUT_PLAYOUTS
+    // партиями на направление, элементы — сыгранные случайные партии.
+    constexpr int ROLLOUT_PLAYOUTS = 32;
+    Game rolloutGame(7);
+    rolloutGame.startNew();
+    Board root = rolloutGame.board();
+    std::vector<unsigned> rolloutThreads = {1};
+    if (std::thread::hardware_concurrency() > 1)
+        rolloutThreads.push_back(std::thread::hardware_concurrency());
+    for (unsigned threads : rolloutThreads) {
+        auto search = std::make_shared<MonteCarloSearch>(threads);
+        search->bestMove(root, ROLLOUT_PLAYOUTS, 0);
+        auto playouts = static_cast<double>(search->stats().playouts);
+        benches.push_back({"rollout/threads:" + std::to_string(threads),
+                           [search, root](std::uint64_t n) {
+            std::uint64_t sum = 0;
+            for (std::uint64_t i = 0; i < n; ++i) {
+                search->bestMove(root, ROLLOUT_PLAYOUTS, i);
+                sum += search->stats().moves;
+            }
+            return sum;
+        }, playouts});
+    }
+
+    return benches;
+}
+
+void printTable(const std::vector<BenchResult>& results) {
+    std::cout << std::left << std::setw(32) << "Benchmark" << std::right << std::setw(14)
+              << "ns/op" << std::setw(14) << "iterations" << std::setw(16) << "items/s" << '\n';
+    std::cout << std::string(76, '-') << '\n';
+    for (const BenchResult& r : results) {
+        std::cout << std::left << std::setw(32) << r.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(14) << r.nsPerOp << std::setw(14)
+                  << r.iterations << std::setprecision(0) << std::setw(16) << r.itemsPerSecond;
+        for (const Counter& c : r.counters)
+            std::cout << "  " << c.name << '=' << std::setprecision(3) << c.value;
+        std::cout << '\n';
+    }
+}
+
+void printJson(const std::vector<BenchResult>& results) {
+    std::cout << "{\n  \"context\": {\n"
+              << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+              << "    \"library_build_type\": \"release\"\n"
+#else
+              << "    \"library_build_type\": \"debug\"\n"
+#endif
+              << "  },\n  \"benchmarks\": [\n";
+    for (std::size_t k = 0; k < results.size(); ++k) {
+        const BenchResult& r = results[k];
+        std::cout << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                  << ", \"real_time\": " << std::setprecision(6) << r.nsPerOp
+                  << ", \"time_unit\": \"ns\", \"items_per_second\": " << std::setprecision(1)
+                  << std::fixed << r.itemsPerSecond << std::defaultfloat;
+        for (const Counter& c : r.counters)
+            std::cout << ", \"" << c.name << "\": " << std::setprecision(6) << c.value;
+        std::cout << "}"
+                  << (k + 1 < results.size() ? "," : "") << '\n';
+    }
+    std::cout << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    double minTime = 0.2;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Usage: 2048_bench [--json] [--min-time SECONDS] [--filter SUBSTRING]\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& bench : registerBenchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        results.push_back(measure(bench, minTime));
+    }
+
+    if (json)
+        printJson(results);
+    else
+        printTable(results);
+    return 0;
+}
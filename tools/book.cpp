@@ -0,0 +1,207 @@
+/**
+ * @file book.cpp
+ * @brief Построение, объединение и просмотр книг ходов (см. book.h).
+ *
+ * Использование:
+ * @code
+ * 2048_book generate --games 1000 --moves 200 --depth 3 --out openings.book
+ * 2048_book merge all.book openings.book endgame.book
+ * 2048_book info all.book
+ * 2048_sim --policy expectimax --depth 3 --book all.book
+ * @endcode
+ *
+ * generate играет партии в симуляторе стратегией expectimax и
+ * записывает в книгу каждую позицию, для которой выполнялся поиск:
+ * поле, лучший ход, его оценку и глубину. С --moves записываются
+ * только первые M ходов партии, дальше партия доигрывается жадной
+ * стратегией. С --canonical симметричные позиции занимают одну запись
+ * (см. canonicalBoard()), и книга меньше до восьми раз; для этого оценка
+ * должна быть симметричной, например --eval gradient=0.
+ */
+
+#include "book.h"
+#include "simulator.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: 2048_book generate [--games N] [--threads T] [--seed S] [--depth D]\n"
+                 "                          [--moves M] [--eval NAME=W,...] [--canonical]\n"
+                 "                          --out FILE\n"
+                 "       2048_book merge OUT IN...\n"
+                 "       2048_book info FILE\n";
+}
+
+// Записи всех потоков генерации.
+struct BookSink {
+    std::mutex mutex;
+    std::vector<BookEntry> entries;
+};
+
+class RecordingPolicy : public Policy {
+public:
+    RecordingPolicy(const SearchBudget& budget, const BoardEvaluator* evaluator, int maxMoves,
+                    BookSink& sink)
+        : expectimax_(budget, nullptr, evaluator), maxMoves_(maxMoves), sink_(sink) {}
+
+    ~RecordingPolicy() override {
+        std::lock_guard lock(sink_.mutex);
+        sink_.entries.insert(sink_.entries.end(), entries_.begin(), entries_.end());
+    }
+
+    RecordingPolicy(const RecordingPolicy&) = delete;
+    RecordingPolicy& operator=(const RecordingPolicy&) = delete;
+
+    void newGame(std::uint64_t seed) override {
+        expectimax_.newGame(seed);
+        moves_ = 0;
+    }
+
+    Direction chooseMove(const Game& game) override {
+        if (maxMoves_ > 0 && moves_ >= maxMoves_) return greedy_.chooseMove(game);
+        ++moves_;
+        Direction dir = expectimax_.chooseMove(game);
+        const SearchStats& stats = expectimax_.search().stats();
+        BookEntry entry;
+        entry.board = game.board();
+        entry.value = stats.value;
+        entry.move = static_cast<std::uint8_t>(dir);
+        entry.depth = static_cast<std::uint8_t>(stats.depth);
+        entries_.push_back(entry);
+        return dir;
+    }
+
+private:
+    ExpectimaxPolicy expectimax_;
+    GreedyPolicy greedy_;
+    int maxMoves_;
+    int moves_ = 0;
+    BookSink& sink_;
+    std::vector<BookEntry> entries_;
+};
+
+int generate(int argc, char** argv) {
+    SimConfig config{100, 0, 1, {}};
+    SearchBudget budget;
+    int maxMoves = 0;
+    bool canonical = false;
+    EvalWeights weights;
+    std::string out;
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--canonical") == 0) {
+            canonical = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            printUsage();
+            return 1;
+        }
+        if (std::strcmp(arg, "--games") == 0) {
+            config.games = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--depth") == 0) {
+            budget.depth = std::atoi(value);
+        } else if (std::strcmp(arg, "--moves") == 0) {
+            maxMoves = std::atoi(value);
+        } else if (std::strcmp(arg, "--eval") == 0) {
+            if (!parseEvalWeights(value, weights)) {
+                std::cerr << "Bad weights: " << value << '\n';
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--out") == 0) {
+            out = value;
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+    if (out.empty()) {
+        printUsage();
+        return 1;
+    }
+    BoardEvaluator evaluator(weights);
+    if (canonical && !evaluator.symmetric()) {
+        // Ход, найденный для одной позиции, неверен для её отражений.
+        std::cerr << "--canonical needs a symmetric evaluation, e.g. --eval gradient=0\n";
+        return 1;
+    }
+
+    BookSink sink;
+    SimReport report = runSimulation(config, [&] {
+        return std::make_unique<RecordingPolicy>(budget, &evaluator, maxMoves, sink);
+    });
+    std::size_t positions = sink.entries.size();
+    if (!writeBook(out, sink.entries, canonical)) {
+        std::cerr << "Cannot write " << out << '\n';
+        return 1;
+    }
+    std::cout << "games:     " << report.games << '\n';
+    std::cout << "positions: " << positions << '\n';
+    std::cout << "entries:   " << sink.entries.size() << '\n';
+    std::cout << "time:      " << report.seconds << " s\n";
+    return 0;
+}
+
+int merge(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::vector<std::string> inputs(argv + 1, argv + argc);
+    if (!mergeBooks(argv[0], inputs)) {
+        std::cerr << "Cannot merge into " << argv[0] << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+int info(int argc, char** argv) {
+    if (argc != 1) {
+        printUsage();
+        return 1;
+    }
+    OpeningBook book;
+    if (!book.open(argv[0])) {
+        std::cerr << "Not a book (or another version): " << argv[0] << '\n';
+        return 1;
+    }
+    std::array<std::size_t, 256> byDepth{};
+    for (std::size_t k = 0; k < book.size(); ++k)
+        ++byDepth[book.entries()[k].depth];
+
+    std::cout << "version:   " << BOOK_VERSION << " (board encoding " << BOARD_ENCODING << ")\n";
+    std::cout << "entries:   " << book.size() << '\n';
+    std::cout << "canonical: " << (book.canonical() ? "yes" : "no") << '\n';
+    for (std::size_t depth = 0; depth < byDepth.size(); ++depth)
+        if (byDepth[depth] != 0)
+            std::cout << "depth " << depth << ":   " << byDepth[depth] << '\n';
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    if (std::strcmp(argv[1], "generate") == 0) return generate(argc - 2, argv + 2);
+    if (std::strcmp(argv[1], "merge") == 0) return merge(argc - 2, argv + 2);
+    if (std::strcmp(argv[1], "info") == 0) return info(argc - 2, argv + 2);
+    printUsage();
+    return 1;
+}
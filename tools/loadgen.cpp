@@ -0,0 +1,268 @@
+/**
+ * @file loadgen.cpp
+ * @brief Нагрузочный клиент для 2048_server.
+ *
+ * Использование:
+ * @code
+ * 2048_loadgen --socket /tmp/2048.sock --sessions 10000 --concurrency 1000 --moves 200
+ * @endcode
+ *
+ * Каждый поток держит открытыми до concurrency / threads соединений.
+ * Соединение начинает партию (REQUEST_NEW), затем делает до --moves
+ * случайных ходов, меняющих поле, по одному запросу за раз; закончив,
+ * закрывается, и на его месте открывается следующая партия. Задержка
+ * хода — время от отправки запроса до получения ответа.
+ */
+
+#include "server.h"
+#include "rng.h"
+#include "simulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string socketPath = "/tmp/2048.sock";
+    std::uint64_t sessions = 1000;
+    unsigned concurrency = 100;
+    unsigned threads = 0;
+    int moves = 200;
+    std::uint64_t seed = 1;
+};
+
+struct Connection {
+    int fd = -1;
+    int movesLeft = 0;
+    Clock::time_point sentAt;
+    bool newGame = true;
+};
+
+struct alignas(64) ThreadResult {
+    std::vector<std::uint32_t> latencies;   // нс, только ходы
+    std::uint64_t sessions = 0;
+    std::uint64_t errors = 0;
+};
+
+void printUsage() {
+    std::cerr << "Usage: 2048_loadgen [--socket PATH] [--sessions N] [--concurrency C]\n"
+                 "                    [--moves M] [--threads T] [--seed S]\n";
+}
+
+int connectTo(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::vector<unsigned char>& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        sent += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool readResponse(int fd, unsigned char* data) {
+    std::size_t got = 0;
+    while (got < RESPONSE_SIZE) {
+        ssize_t n = ::read(fd, data + got, RESPONSE_SIZE - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        got += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void runClient(const Options& options, unsigned thread, unsigned slots,
+               std::atomic<std::uint64_t>& nextSession, ThreadResult& result) {
+    std::vector<Connection> connections(slots);
+    std::vector<pollfd> polls(slots);
+    std::vector<unsigned char> request;
+    // У каждого потока свой поток ходов, даже при равном числе слотов.
+    Rng rng(gameSeed(options.seed, thread));
+
+    // Открывает следующую партию в слоте или оставляет слот пустым.
+    auto open = [&](std::size_t slot) {
+        Connection& c = connections[slot];
+        c.fd = -1;
+        std::uint64_t index = nextSession.fetch_add(1, std::memory_order_relaxed);
+        if (index >= options.sessions) return;
+        c.fd = connectTo(options.socketPath);
+        if (c.fd < 0) {
+            ++result.errors;
+            return;
+        }
+        request.clear();
+        encodeNewRequest(gameSeed(options.seed, index), request);
+        c.movesLeft = options.moves;
+        c.newGame = true;
+        c.sentAt = Clock::now();
+        if (!sendAll(c.fd, request)) ++result.errors;
+    };
+    auto finish = [&](std::size_t slot) {
+        ::close(connections[slot].fd);
+        ++result.sessions;
+        open(slot);
+    };
+
+    for (std::size_t slot = 0; slot < slots; ++slot) open(slot);
+    while (true) {
+        std::size_t active = 0;
+        for (std::size_t slot = 0; slot < slots; ++slot) {
+            polls[slot].fd = connections[slot].fd;
+            polls[slot].events = POLLIN;
+            polls[slot].revents = 0;
+            if (connections[slot].fd >= 0) ++active;
+        }
+        if (active == 0) return;
+        if (::poll(polls.data(), polls.size(), -1) < 0 && errno != EINTR) return;
+
+        for (std::size_t slot = 0; slot < slots; ++slot) {
+            if ((polls[slot].revents & (POLLIN | POLLHUP | POLLERR)) == 0) continue;
+            Connection& c = connections[slot];
+            unsigned char data[RESPONSE_SIZE];
+            if (!readResponse(c.fd, data)) {
+                ++result.errors;
+                finish(slot);
+                continue;
+            }
+            auto now = Clock::now();
+            if (!c.newGame)
+                result.latencies.push_back(static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - c.sentAt).count()));
+            c.newGame = false;
+
+            ServerResponse response = decodeResponse(data);
+            if (response.status != RESPONSE_OK) ++result.errors;
+            if (response.status != RESPONSE_OK || (response.flags & RESPONSE_GAME_OVER) != 0 ||
+                c.movesLeft-- <= 0) {
+                finish(slot);
+                continue;
+            }
+
+            // Случайный ход из тех, что меняют поле.
+            Direction legal[4];
+            int count = 0;
+            for (Direction dir : ALL_DIRECTIONS) {
+                int unused = 0;
+                if (moveBoard(response.board, dir, unused) != response.board) legal[count++] = dir;
+            }
+            if (count == 0) {
+                finish(slot);
+                continue;
+            }
+            request.clear();
+            encodeMoveRequest(legal[rng.next() % static_cast<std::uint64_t>(count)], request);
+            c.sentAt = Clock::now();
+            if (!sendAll(c.fd, request)) {
+                ++result.errors;
+                finish(slot);
+            }
+        }
+    }
+}
+
+double percentileUs(const std::vector<std::uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))] / 1000.0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            printUsage();
+            return 1;
+        }
+        if (std::strcmp(arg, "--socket") == 0) {
+            options.socketPath = value;
+        } else if (std::strcmp(arg, "--sessions") == 0) {
+            options.sessions = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--concurrency") == 0) {
+            options.concurrency = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--moves") == 0) {
+            options.moves = std::atoi(value);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+    unsigned threads = options.threads != 0 ? options.threads
+                                            : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1u, std::min(threads, options.concurrency));
+
+    std::atomic<std::uint64_t> nextSession{0};
+    std::vector<ThreadResult> results(threads);
+    auto start = Clock::now();
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned t = 0; t < threads; ++t) {
+            unsigned slots = options.concurrency / threads + (t < options.concurrency % threads);
+            pool.emplace_back([&, t, slots] { runClient(options, t, slots, nextSession, results[t]); });
+        }
+    }
+    double seconds = std::max(std::chrono::duration<double>(Clock::now() - start).count(), 1e-9);
+
+    std::vector<std::uint32_t> latencies;
+    std::uint64_t sessions = 0;
+    std::uint64_t errors = 0;
+    for (const ThreadResult& r : results) {
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        sessions += r.sessions;
+        errors += r.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "threads:      " << threads << '\n';
+    std::cout << "concurrency:  " << options.concurrency << '\n';
+    std::cout << "sessions:     " << sessions << '\n';
+    std::cout << "moves:        " << latencies.size() << '\n';
+    std::cout << "errors:       " << errors << '\n';
+    std::cout << "time:         " << seconds << " s\n";
+    std::cout << "sessions/sec: " << static_cast<double>(sessions) / seconds << '\n';
+    std::cout << "moves/sec:    " << static_cast<double>(latencies.size()) / seconds << '\n';
+    std::cout << "\nmove latency (us): p50 " << percentileUs(latencies, 0.5)
+              << "  p90 " << percentileUs(latencies, 0.9)
+              << "  p99 " << percentileUs(latencies, 0.99)
+              << "  max " << percentileUs(latencies, 1.0) << '\n';
+    return errors == 0 ? 0 : 1;
+}
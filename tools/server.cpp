@@ -0,0 +1,107 @@
+/**
+ * @file server.cpp
+ * @brief Сервер партий на сокете Unix (см. server.h).
+ *
+ * Использование:
+ * @code
+ * 2048_server --socket /tmp/2048.sock --loops 4 --store sessions.bin
+ * 2048_loadgen --socket /tmp/2048.sock --sessions 10000 --concurrency 1000
+ * @endcode
+ *
+ * Работает до SIGINT или SIGTERM, раз в --report секунд печатает число
+ * открытых соединений и запросов в секунду. При остановке все партии
+ * записываются в --store.
+ */
+
+#include "server.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+void printUsage() {
+    std::cerr << "Usage: 2048_server [--socket PATH] [--loops N] [--store FILE]\n"
+                 "                   [--save-ms MS] [--report SEC]\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    ServerConfig config;
+    config.socketPath = "/tmp/2048.sock";
+    double reportSeconds = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            printUsage();
+            return 1;
+        }
+        if (std::strcmp(arg, "--socket") == 0) {
+            config.socketPath = value;
+        } else if (std::strcmp(arg, "--loops") == 0) {
+            config.loops = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--store") == 0) {
+            config.storePath = value;
+        } else if (std::strcmp(arg, "--save-ms") == 0) {
+            config.saveInterval = std::chrono::milliseconds(std::strtoll(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--report") == 0) {
+            reportSeconds = std::strtod(value, nullptr);
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+    if (config.saveInterval.count() <= 0) {
+        std::cerr << "--save-ms must be positive\n";
+        printUsage();
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    GameServer server(config);
+    if (!server.start()) {
+        std::cerr << "Cannot listen on " << config.socketPath << " (or bad store "
+                  << config.storePath << ")\n";
+        return 1;
+    }
+    std::cout << "listening: " << config.socketPath << "  loops: " << server.loops() << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    std::cout << std::fixed << std::setprecision(1);
+    auto lastReport = Clock::now();
+    ServerStats previous = server.stats();
+    while (stopRequested == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = Clock::now();
+        double interval = std::chrono::duration<double>(now - lastReport).count();
+        if (interval < reportSeconds) continue;
+        ServerStats current = server.stats();
+        std::cout << "active " << std::setw(8) << current.active << "  connections "
+                  << std::setw(10) << current.connections << "  requests/sec " << std::setw(12)
+                  << static_cast<double>(current.requests - previous.requests) / interval
+                  << "  saves " << current.saves << std::endl;
+        previous = current;
+        lastReport = now;
+    }
+
+    server.stop();
+    return 0;
+}
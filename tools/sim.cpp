@@ -0,0 +1,157 @@
+/**
+ * @file sim.cpp
+ * @brief Консольный симулятор: играет партии без интерфейса во всех потоках.
+ *
+ * Использование:
+ * @code
+ * 2048_sim --games 100000 --threads 8 --seed 42 --policy greedy
+ * 2048_sim --games 100 --policy expectimax --time-us 2000
+ * 2048_sim --games 100 --policy montecarlo --playouts 50
+ * 2048_sim --games 100 --policy expectimax --depth 3 --book openings.book
+ * 2048_sim --games 100 --policy expectimax --depth 2 --eval smoothness=5,monotonicity=20
+ * 2048_sim --games 10000 --policy ntuple --weights small.ntuple   # см. 2048_train
+ * 2048_sim --games 1000000 --record games.rec   # затем 2048_analyze games.rec
+ * @endcode
+ */
+
+#include "profile.h"
+#include "book.h"
+#include "simulator.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: 2048_sim [--games N] [--threads T] [--seed S] [--policy NAME]\n"
+                 "                [--depth D] [--time-us T] [--playouts K] [--book FILE]\n"
+                 "                [--eval NAME=W,...] [--weights FILE] [--record FILE]\n";
+    std::cerr << "Policies:";
+    for (const std::string& name : policyNames())
+        std::cerr << ' ' << name;
+    std::cerr << '\n';
+}
+
+int percentile(const std::vector<int>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[idx];
+}
+
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    std::string policyName = "random";
+    SearchBudget budget;
+    std::string bookPath;
+    EvalWeights weights;
+    std::string networkPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            printUsage();
+            return 1;
+        }
+        if (std::strcmp(arg, "--games") == 0) {
+            config.games = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--policy") == 0) {
+            policyName = value;
+        } else if (std::strcmp(arg, "--depth") == 0) {
+            budget.depth = std::atoi(value);
+        } else if (std::strcmp(arg, "--time-us") == 0) {
+            budget.time = std::chrono::microseconds(std::strtoll(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--record") == 0) {
+            config.recordPath = value;
+        } else if (std::strcmp(arg, "--book") == 0) {
+            bookPath = value;
+        } else if (std::strcmp(arg, "--eval") == 0) {
+            if (!parseEvalWeights(value, weights)) {
+                std::cerr << "Bad weights: " << value << '\n';
+                return 1;
+            }
+        } else if (std::strcmp(arg, "--weights") == 0) {
+            networkPath = value;
+        } else if (std::strcmp(arg, "--playouts") == 0) {
+            budget.playouts = std::atoi(value);
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+
+    OpeningBook book;
+    if (!bookPath.empty() && !book.open(bookPath)) {
+        std::cerr << "Cannot open book: " << bookPath << '\n';
+        return 1;
+    }
+
+    NTupleNetwork network;
+    if (!networkPath.empty() && !network.open(networkPath)) {
+        std::cerr << "Cannot open weights: " << networkPath << '\n';
+        return 1;
+    }
+    if (policyName == "ntuple" && !network.isOpen()) {
+        std::cerr << "Policy ntuple needs --weights\n";
+        return 1;
+    }
+
+    BoardEvaluator evaluator(weights);
+    PolicyFactory factory = policyByName(policyName, budget, bookPath.empty() ? nullptr : &book,
+                                         &evaluator, &network);
+    if (!factory) {
+        std::cerr << "Unknown policy: " << policyName << '\n';
+        printUsage();
+        return 1;
+    }
+
+    SimReport report = runSimulation(config, factory);
+
+    double seconds = report.seconds > 0.0 ? report.seconds : 1e-9;
+    long long total = 0;
+    for (int s : report.scores) total += s;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "policy:      " << policyName << '\n';
+    std::cout << "threads:     " << report.threads << '\n';
+    std::cout << "games:       " << report.games << '\n';
+    std::cout << "moves:       " << report.moves << '\n';
+    std::cout << "time:        " << seconds << " s\n";
+    std::cout << "games/sec:   " << static_cast<double>(report.games) / seconds << '\n';
+    std::cout << "moves/sec:   " << static_cast<double>(report.moves) / seconds << '\n';
+    std::cout << "\nscore: min " << percentile(report.scores, 0.0)
+              << "  p50 " << percentile(report.scores, 0.5)
+              << "  p90 " << percentile(report.scores, 0.9)
+              << "  p99 " << percentile(report.scores, 0.99)
+              << "  max " << percentile(report.scores, 1.0)
+              << "  mean "
+              << (report.games ? static_cast<double>(total) / static_cast<double>(report.games) : 0.0)
+              << '\n';
+
+    std::cout << "\nmax tile:\n";
+    for (std::size_t e = 1; e < report.maxTileHistogram.size(); ++e) {
+        std::uint64_t count = report.maxTileHistogram[e];
+        if (count == 0) continue;
+        std::cout << std::setw(8) << (1 << e) << "  " << std::setw(10) << count << "  "
+                  << std::setw(6)
+                  << 100.0 * static_cast<double>(count) / static_cast<double>(report.games)
+                  << "%\n";
+    }
+
+    if (PROFILE_ENABLED) {
+        std::cout << '\n';
+        printProfile(std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file train.cpp
+ * @brief Обучение сети n-кортежей игрой с собой (см. trainer.h).
+ *
+ * Использование:
+ * @code
+ * 2048_train --out small.ntuple                              # до Ctrl-C
+ * 2048_train --out large.ntuple --tuples large --threads 16 --checkpoint 600
+ * 2048_train --out small.ntuple --resume small.ntuple --games 100000 --lambda 0.5
+ * 2048_sim --games 10000 --policy ntuple --weights small.ntuple
+ * @endcode
+ *
+ * Каждые --report секунд печатается строка с числом партий, скоростью
+ * и средним счётом партий, законченных за этот интервал. Каждые
+ * --checkpoint секунд и при завершении (в том числе по SIGINT или
+ * SIGTERM) веса записываются в --out атомарно, так что файл всегда
+ * можно открыть, даже если обучение прервано.
+ */
+
+#include "trainer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onSignal(int) {
+    stopRequested = 1;
+}
+
+void printUsage() {
+    std::cerr << "Usage: 2048_train --out FILE [--tuples small|large] [--resume FILE]\n"
+                 "                  [--games N] [--threads T] [--seed S] [--rate A]\n"
+                 "                  [--lambda L] [--report SEC] [--checkpoint SEC]\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    TrainConfig config;
+    std::string out;
+    std::string tuples = "small";
+    std::string resume;
+    double reportSeconds = 10.0;
+    double checkpointSeconds = 300.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) {
+            printUsage();
+            return 1;
+        }
+        if (std::strcmp(arg, "--out") == 0) {
+            out = value;
+        } else if (std::strcmp(arg, "--tuples") == 0) {
+            tuples = value;
+        } else if (std::strcmp(arg, "--resume") == 0) {
+            resume = value;
+        } else if (std::strcmp(arg, "--games") == 0) {
+            config.games = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--rate") == 0) {
+            config.learningRate = std::strtof(value, nullptr);
+        } else if (std::strcmp(arg, "--lambda") == 0) {
+            config.lambda = std::strtof(value, nullptr);
+        } else if (std::strcmp(arg, "--report") == 0) {
+            reportSeconds = std::strtod(value, nullptr);
+        } else if (std::strcmp(arg, "--checkpoint") == 0) {
+            checkpointSeconds = std::strtod(value, nullptr);
+        } else {
+            printUsage();
+            return 1;
+        }
+        ++i;
+    }
+    if (out.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    NTupleNetwork network;
+    if (!resume.empty()) {
+        if (!network.open(resume, true)) {
+            std::cerr << "Cannot open weights: " << resume << '\n';
+            return 1;
+        }
+    } else if (!network.create(ntuplePatterns(tuples))) {
+        std::cerr << "Unknown tuple set or not enough memory: " << tuples << '\n';
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    using Clock = std::chrono::steady_clock;
+    NTupleTrainer trainer(network, config);
+    std::cout << "threads: " << trainer.threads() << "  features: " << network.features()
+              << "  out: " << out << '\n';
+    std::cout << std::fixed << std::setprecision(1);
+
+    auto start = Clock::now();
+    auto lastReport = start;
+    auto lastCheckpoint = start;
+    TrainProgress previous;
+    bool done = false;
+    while (!done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        done = stopRequested != 0 || trainer.finished();
+        auto now = Clock::now();
+
+        if (done || std::chrono::duration<double>(now - lastReport).count() >= reportSeconds) {
+            TrainProgress current = trainer.progress();
+            double interval = std::max(std::chrono::duration<double>(now - lastReport).count(), 1e-9);
+            std::uint64_t games = current.games - previous.games;
+            double average = games != 0 ? static_cast<double>(current.scoreSum - previous.scoreSum) /
+                                              static_cast<double>(games)
+                                        : 0.0;
+            std::cout << "time " << std::setw(9) << std::chrono::duration<double>(now - start).count()
+                      << " s  games " << std::setw(10) << current.games << "  games/sec "
+                      << std::setw(8) << static_cast<double>(games) / interval << "  moves/sec "
+                      << std::setw(10)
+                      << static_cast<double>(current.moves - previous.moves) / interval
+                      << "  avg score " << std::setw(9) << average << "  max " << current.maxScore
+                      << std::endl;
+            previous = current;
+            lastReport = now;
+        }
+
+        if (!done && std::chrono::duration<double>(now - lastCheckpoint).count() >= checkpointSeconds) {
+            if (!network.save(out)) std::cerr << "Cannot write " << out << '\n';
+            lastCheckpoint = now;
+        }
+    }
+
+    trainer.stop();
+    if (!network.save(out)) {
+        std::cerr << "Cannot write " << out << '\n';
+        return 1;
+    }
+    return 0;
+}